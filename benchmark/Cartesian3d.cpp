@@ -0,0 +1,88 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <catch2/catch.hpp>
+#include <GMatElastoPlasticQPot3d/Cartesian3d.h>
+
+namespace GM = GMatElastoPlasticQPot3d::Cartesian3d;
+
+TEST_CASE("GMatElastoPlasticQPot3d::Cartesian3d", "Cartesian3d.h")
+{
+    size_t nelem = 10000;
+    size_t nip = 4;
+
+    GM::Array<2> mat({nelem, nip});
+    mat.setCusp(xt::ones<size_t>({nelem, nip}), 12.3, 45.6, 0.01 + 0.02 * xt::arange<double>(100));
+
+    xt::xtensor<double, 6> C = xt::empty<double>({nelem, nip, 3ul, 3ul, 3ul, 3ul});
+
+    xt::xtensor<size_t, 2> I = xt::ones<size_t>({nelem, nip});
+    xt::xtensor<size_t, 2> idx = xt::empty<size_t>({nelem, nip});
+    xt::xtensor<double, 1> K = 12.3 * xt::ones<double>({nelem});
+    xt::xtensor<double, 1> G = 45.6 * xt::ones<double>({nelem});
+    xt::xtensor<double, 2> epsy = xt::empty<double>({nelem, 100ul});
+
+    for (size_t e = 0; e < nelem; ++e) {
+        for (size_t q = 0; q < nip; ++q) {
+            idx(e, q) = e;
+        }
+        for (size_t j = 0; j < 100; ++j) {
+            epsy(e, j) = 0.01 + 0.02 * static_cast<double>(j) + 1e-6 * static_cast<double>(e);
+        }
+    }
+
+    BENCHMARK("Array::setCusp - landscape per element")
+    {
+        GM::Array<2> bulk({nelem, nip});
+        bulk.setCusp(I, idx, K, G, epsy);
+        return bulk.K()(0, 0);
+    };
+
+    BENCHMARK("Array::setCusp - procedural landscape")
+    {
+        GM::Array<2> bulk({nelem, nip});
+        bulk.setCusp(I, 12.3, 45.6, GM::Procedural(GM::Procedural::Weibull, 2.0, 0.02, 0.01));
+        return bulk.K()(0, 0);
+    };
+
+    BENCHMARK("Array::tangent")
+    {
+        mat.tangent(C);
+        return C(0, 0, 0, 0, 0, 0);
+    };
+
+    BENCHMARK("Array::tangent - reference: K * II + 2 * G * I4d per point")
+    {
+        auto K = mat.K();
+        auto G = mat.G();
+        auto II = GM::II();
+        auto I4d = GM::I4d();
+        for (size_t i = 0; i < nelem * nip; ++i) {
+            auto Ci = K.data()[i] * II + 2.0 * G.data()[i] * I4d;
+            std::copy(Ci.cbegin(), Ci.cend(), &C.data()[i * 81]);
+        }
+        return C(0, 0, 0, 0, 0, 0);
+    };
+
+    xt::xtensor<double, 4> Eps = xt::zeros<double>({nelem, nip, 3ul, 3ul});
+    xt::xtensor<double, 4> Sig = xt::empty<double>({nelem, nip, 3ul, 3ul});
+    xt::xtensor<double, 2> U = xt::empty<double>({nelem, nip});
+
+    for (size_t e = 0; e < nelem; ++e) {
+        for (size_t q = 0; q < nip; ++q) {
+            Eps(e, q, 0, 1) = Eps(e, q, 1, 0) = 1e-4 * static_cast<double>(e % 1000);
+        }
+    }
+
+    BENCHMARK("Array::setStrain(Eps, Sig, U)")
+    {
+        mat.setStrain(Eps, Sig, U);
+        return U(0, 0);
+    };
+
+    BENCHMARK("Array::setStrain(Eps, Sig, U) - reference: setStrain, stress, energy")
+    {
+        mat.setStrain(Eps);
+        mat.stress(Sig);
+        mat.energy(U);
+        return U(0, 0);
+    };
+}
@@ -0,0 +1,4 @@
+
+#define CATCH_CONFIG_MAIN  // tells Catch to provide a main() - only do this in one cpp file
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <catch2/catch.hpp>
@@ -14,8 +14,23 @@
 #include <GMatTensor/Cartesian3d.h>
 #include <GMatElastic/Cartesian3d.h>
 #include <math.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
 #include <xtensor/xsort.hpp>
 
+#ifdef XTENSOR_USE_XSIMD
+#include <xsimd/xsimd.hpp>
+#endif
+
 #include "config.h"
 
 namespace GMatElastoPlasticQPot3d {
@@ -55,6 +70,211 @@ inline void sigd(const T& A, U& B);
 template <class T>
 inline auto Sigd(const T& A);
 
+// Storage format of the strain and stress of "Array", per point
+// (see "Array::setStorageMandel" and "Array::setStoragePlaneStrain")
+
+struct Storage {
+    enum Value {
+        Tensor,      // "[xx, xy, xz, yx, yy, yz, zx, zy, zz]"
+        Mandel,      // "[xx, yy, zz, sqrt(2) yz, sqrt(2) xz, sqrt(2) xy]"
+        PlaneStrain, // "[xx, xy, yy, zz]" (zero out-of-plane shear)
+    };
+};
+
+// Pointer-based kernels, shared by the material points and "Array"
+
+namespace detail {
+
+// Sorted yield strains, prepended by "-epsy[0]" if "init_elastic" and the first well is not
+// symmetric around zero
+inline xt::xtensor<double, 1>
+yield_sequence(const xt::xtensor<double, 1>& epsy, bool init_elastic);
+
+// Idem, without a copy: the number of entries prepended to the "n" yield strains "epsy" (0 or 1)
+inline size_t yield_sequence_prepend(const double* epsy, size_t n, bool init_elastic);
+
+// Idem, written to "out" (of size "n + prepend", see "yield_sequence_prepend")
+template <class T>
+inline void yield_sequence(const double* epsy, size_t n, size_t prepend, T* out);
+
+// Index "i" such that "epsy[i] < x <= epsy[i + 1]", searching from the guess "i"
+// (the result is clipped to "[0, n - 2]": "x" outside the yield strains is not detected here,
+// see "Array::checkYieldBoundLeft")
+template <class T>
+inline size_t yield_index(const T* epsy, size_t n, size_t i, double x);
+
+// Counter-based random number in "(0, 1)": a function of "(seed, stream, counter)" only
+inline double random(uint64_t seed, uint64_t stream, uint64_t counter);
+
+// Marks a landscape that is stored (not generated)
+constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+// Number of landscapes that are generated at once (see "Array::setCusp")
+constexpr size_t landscape_batch = 1024;
+
+// Number of points per chunk when grouping the points by type (see "Array::groupTypes")
+constexpr size_t group_chunk = 4096;
+
+// Hydrostatic/deviatoric decomposition "Eps = epsm * I + Epsd", returns the equivalent strain
+inline double strain_decomposition(const double* Eps, double* Epsd, double& epsm);
+
+// Smallest "t >= 0" for which the equivalent strain of "Eps + t * dEps" is "epsy_l" or "epsy_r"
+// (infinity if it never is)
+inline double
+distance_to_yield(const double* Eps, const double* dEps, double epsy_l, double epsy_r);
+
+// Stress "Sig = 3 * K * epsm * I + g * Epsd"
+template <class T>
+inline void stress(double K, double epsm, double g, const double* Epsd, T* Sig);
+
+// Factor "g" relating the stress deviator to the strain deviator
+inline double g_elastic(double G);
+inline double g_cusp(double G, double epsd, double epsy_l, double epsy_r);
+inline double g_smooth(double G, double epsd, double epsy_l, double epsy_r);
+
+// Fourth-order tensors as compile-time constants (row-major storage of "[i, j, k, l]")
+struct Tensor4 {
+    double data[81];
+};
+
+constexpr Tensor4 II_data();  // dyadic(I2, I2)
+constexpr Tensor4 I4d_data(); // deviatoric projection
+
+// Tangent "C = K * II + 2 * G * I4d" written to "C" (81 entries, no allocation)
+template <class T>
+inline void tangent(double K, double G, T* C);
+
+// Tangent contracted with a second-order tensor "B = C : A" (9 entries each)
+template <class T>
+inline void tangent_ddot(double K, double G, const T* A, T* B);
+
+// Tangent as 6x6 matrix, components ordered [xx, yy, zz, yz, xz, xy]
+// (Voigt: for engineering shear strains, Mandel: orthonormal basis with "sqrt(2)" weights)
+template <class T>
+inline void tangent_voigt(double K, double G, T* C);
+
+template <class T>
+inline void tangent_mandel(double K, double G, T* C);
+
+// Mandel components "[xx, yy, zz, sqrt(2) yz, sqrt(2) xz, sqrt(2) xy]" of a symmetric tensor
+template <class T, class U>
+inline void to_mandel(const T* A, U* M);
+
+template <class T, class U>
+inline void from_mandel(const T* M, U* A);
+
+// In-plane components and out-of-plane normal "[xx, xy, yy, zz]" of a symmetric tensor
+// (the out-of-plane shear is ignored, and zero on output)
+template <class T, class U>
+inline void to_plane(const T* A, U* P);
+
+template <class T, class U>
+inline void from_plane(const T* P, U* A);
+
+// Number of components of a point stored as "storage" (see "Storage"),
+// and conversion of a point from/to all 9 components
+inline size_t storage_size(size_t storage);
+template <class T, class U>
+inline void to_storage(size_t storage, const T* A, U* B);
+
+template <class T, class U>
+inline void from_storage(size_t storage, const T* B, U* A);
+
+// Energy
+inline double energy_elastic(double K, double G, double epsm, double epsd);
+inline double energy_cusp(
+    double K,
+    double G,
+    double epsm,
+    double epsd,
+    double epsy_l,
+    double epsy_r);
+inline double energy_smooth(
+    double K,
+    double G,
+    double epsm,
+    double epsd,
+    double epsy_l,
+    double epsy_r);
+
+// Batched kernels: a block of points is evaluated lane-wise (using xsimd if available)
+
+namespace simd {
+
+#ifdef XTENSOR_USE_XSIMD
+using batch = xsimd::simd_type<double>;
+constexpr size_t size = xsimd::simd_traits<double>::size;
+#else
+using batch = double;
+constexpr size_t size = 1;
+#endif
+
+constexpr size_t block = 8; // number of points per block
+
+static_assert(block % size == 0, "block must be a multiple of the simd width");
+
+inline batch load(const double* arg);
+inline void store(double* ret, const batch& arg);
+
+} // namespace simd
+
+// Lane-wise storage of a block of points
+struct Block {
+    std::array<std::array<double, simd::block>, 9> Epsd; // strain deviator, per component
+    std::array<double, simd::block> epsm;   // hydrostatic strain
+    std::array<double, simd::block> epsd;   // equivalent strain
+    std::array<double, simd::block> K;      // bulk modulus
+    std::array<double, simd::block> G;      // shear modulus
+    std::array<double, simd::block> epsy_l; // current yield strain left
+    std::array<double, simd::block> epsy_r; // current yield strain right
+    std::array<double, simd::block> g;      // factor relating stress and strain deviator
+};
+
+// Decomposition of the strain of "n <= simd::block" consecutive points, stored as "storage"
+// (unused lanes are padded with a zero strain and a well "[-1, 1]" that give a zero stress)
+template <class T>
+inline void
+strain_decomposition(const T* Eps, size_t n, Block& b, size_t storage = Storage::Tensor);
+
+// Idem for "Storage::PlaneStrain", evaluating only the non-zero components
+// (only "Epsd" components "xx", "xy", "yy", and "zz" are set)
+template <class T>
+inline void strain_decomposition_plane(const T* Eps, size_t n, Block& b);
+
+// Factor "g", without branches ("epsd <= 0" is blended)
+inline void g_elastic(Block& b);
+inline void g_cusp(Block& b);
+inline void g_smooth(Block& b);
+
+// Stress of "n <= simd::block" consecutive points (stored as in "strain_decomposition")
+template <class T>
+inline void stress(const Block& b, size_t n, T* Sig, size_t storage = Storage::Tensor);
+
+template <class T>
+inline void stress_plane(const Block& b, size_t n, T* Sig);
+
+// Binary file I/O (see "Array::save"): contiguous blocks "(data, nbytes)" stored back-to-back
+// from byte "offset", split in chunks of at most "io_chunk" bytes that are read/written in
+// parallel (each thread with its own stream; the file must exist). Returns "false" on failure.
+
+constexpr size_t io_chunk = 1 << 24;
+
+inline bool parallel_io(
+    const std::string& filename,
+    const std::vector<std::pair<char*, size_t>>& blocks,
+    size_t offset,
+    bool write);
+
+// Checkpoint file (see "Array::save"): version, and a tag to detect another byte order
+constexpr uint64_t checkpoint_version = 2;
+constexpr uint64_t checkpoint_order = 0x0102030405060708;
+
+// Bit pattern of a "double", and back (to store it as "uint64_t")
+inline uint64_t bits(double x);
+inline double from_bits(uint64_t x);
+
+} // namespace detail
+
 // Material point
 
 class Elastic : public GMatElastic::Cartesian3d::Elastic
@@ -72,6 +292,16 @@ public:
     Cusp() = default;
     Cusp(double K, double G, const xt::xtensor<double, 1>& epsy, bool init_elastic = true);
 
+    // Idem, with initial strain "Eps": the yield index is searched from "Eps" directly
+    // (e.g. to restart from a large strain, without passing all wells from zero strain)
+
+    Cusp(
+        double K,
+        double G,
+        const xt::xtensor<double, 1>& epsy,
+        const xt::xtensor<double, 2>& Eps,
+        bool init_elastic = true);
+
     double K() const; // bulk modulus
     double G() const; // shear modulus
     xt::xtensor<double, 1> epsy() const; // yield strains
@@ -84,6 +314,8 @@ public:
     double currentYieldRight() const; // yield strain right epsy[index + 1]
     double epsp() const;   // "plastic strain" = 0.5 * (currentYieldLeft + currentYieldRight)
     double energy() const; // potential energy
+    double epsd() const;   // equivalent strain
+    double sigd() const;   // equivalent stress
 
     // Check that 'the particle' is at least "n" wells from the far-left/right
     bool checkYieldBoundLeft(size_t n = 0) const;
@@ -109,6 +341,8 @@ private:
     QPot::Static m_yield;        // potential energy landscape
     std::array<double, 9> m_Eps; // strain tensor [xx, xy, xz, yx, yy, yz, zx, zy, zz]
     std::array<double, 9> m_Sig; // stress tensor ,,
+    double m_epsm = 0.0;         // hydrostatic strain
+    double m_epsd = 0.0;         // equivalent strain
 };
 
 // Material point
@@ -119,6 +353,16 @@ public:
     Smooth() = default;
     Smooth(double K, double G, const xt::xtensor<double, 1>& epsy, bool init_elastic = true);
 
+    // Idem, with initial strain "Eps": the yield index is searched from "Eps" directly
+    // (e.g. to restart from a large strain, without passing all wells from zero strain)
+
+    Smooth(
+        double K,
+        double G,
+        const xt::xtensor<double, 1>& epsy,
+        const xt::xtensor<double, 2>& Eps,
+        bool init_elastic = true);
+
     double K() const; // bulk modulus
     double G() const; // shear modulus
     xt::xtensor<double, 1> epsy() const; // yield strains
@@ -131,6 +375,8 @@ public:
     double currentYieldRight() const; // yield strain right epsy[index + 1]
     double epsp() const;   // "plastic strain" = 0.5 * (currentYieldLeft + currentYieldRight)
     double energy() const; // potential energy
+    double epsd() const;   // equivalent strain
+    double sigd() const;   // equivalent stress
 
     // Check that 'the particle' is at least "n" wells from the far-left/right
     bool checkYieldBoundLeft(size_t n = 0) const;
@@ -156,6 +402,8 @@ private:
     QPot::Static m_yield;        // potential energy landscape
     std::array<double, 9> m_Eps; // strain tensor [xx, xy, xz, yx, yy, yz, zx, zy, zz]
     std::array<double, 9> m_Sig; // stress tensor ,,
+    double m_epsm = 0.0;         // hydrostatic strain
+    double m_epsd = 0.0;         // equivalent strain
 };
 
 // Material identifier
@@ -169,9 +417,85 @@ struct Type {
     };
 };
 
-// Array of material points
+// Procedurally generated potential energy landscape (Array only):
+// the yield strains of point "p" are "epsy[n + 1] = epsy[n] + increment(p, n)", with the first
+// well symmetric around zero ("epsy[0] = -0.5 * increment(p, 0)"), and the increments drawn
+// from "distribution" using a counter-based random number "u" (no state is stored).
+// Only "window" consecutive yield strains, around the current index, are stored per point.
+
+struct Procedural {
+    enum Distribution {
+        Weibull, // "offset + b * (-log(1 - u))^(1 / a)" (shape "a", scale "b")
+        Uniform, // "offset + a + (b - a) * u"
+        Delta,   // "offset + a"
+    };
+
+    Procedural() = default;
+
+    Procedural(
+        Distribution distribution,
+        double a,
+        double b = 0.0,
+        double offset = 0.0,
+        uint64_t seed = 0,
+        size_t window = 1000);
+
+    double increment(size_t p, size_t n) const; // "epsy[n + 1] - epsy[n]" of point "p"
+
+    Distribution distribution = Delta;
+    double a = 1.0;
+    double b = 0.0;
+    double offset = 0.0;
+    uint64_t seed = 0;
+    size_t window = 1000; // number of yield strains stored per point
+};
+
+// Read-only array of "T" in a file, that is memory-mapped (not read into memory), to set "Array"
+// from (e.g. "Array::setCusp"):
+// - ".npy" file: C-contiguous, little-endian, with dtype "<f8" for "double", "<f4" for "float",
+//   or "<u8" / "<i8" (non-negative) for "size_t";
+// - raw binary file: row-major, little-endian, with a given "shape", starting at byte "offset".
+// (Without "mmap", i.e. on Windows, the file is read into memory.)
+
+template <class T>
+class Mapped
+{
+public:
+    Mapped() = default;
+    Mapped(const std::string& filename); // ".npy"
+    Mapped(const std::string& filename, const std::vector<size_t>& shape, size_t offset = 0);
+
+    Mapped(const Mapped&) = delete;
+    Mapped& operator=(const Mapped&) = delete;
+    Mapped(Mapped&& other) noexcept;
+    Mapped& operator=(Mapped&& other) noexcept;
+    ~Mapped();
+
+    const std::vector<size_t>& shape() const;
+    size_t size() const;
+    const T* data() const;
+
+private:
+    // Map "filename", the data start at byte "offset"
+    void map(const std::string& filename, size_t offset);
+
+    // Release the mapping
+    void unmap();
+
+    std::vector<size_t> m_shape;
+    size_t m_size = 0;
+    const T* m_data = nullptr;
+    void* m_map = nullptr;    // mapped file
+    size_t m_map_size = 0;    // size of the mapped file in bytes
+    std::vector<char> m_read; // file read into memory (without "mmap")
+};
+
+// Array of material points.
+// "S" is the scalar type in which the strain, the stress, and the yield strains are stored:
+// "float" halves their memory footprint ("mixed precision"), all computations (decomposition,
+// yield search, stress, energy) are done in "double".
 
-template <size_t N>
+template <size_t N, class S = double>
 class Array : public GMatTensor::Cartesian3d::Array<N>
 {
 public:
@@ -227,6 +551,47 @@ public:
         const xt::xtensor<double, 1>& epsy,
         bool init_elastic = true);
 
+    // Set parameters for a batch of points, with procedurally generated landscapes:
+    // each point has its own (unbounded) landscape, see "Procedural";
+    // "currentIndex" is the index in the full landscape
+
+    void setCusp(
+        const xt::xtensor<size_t, N>& I,
+        double K,
+        double G,
+        const Procedural& epsy);
+
+    void setSmooth(
+        const xt::xtensor<size_t, N>& I,
+        double K,
+        double G,
+        const Procedural& epsy);
+
+    // Idem, warm-started (e.g. to restart from a previous run): each point starts in well
+    // "index" (in the full landscape, see "currentIndex"), of which the left yield strain is
+    // "epsy_l" (see "currentYieldLeft"), at strain "Eps" (only the selected points are used),
+    // which must lie in that well.
+    // The window is generated from that well directly (the cost does not depend on "index"),
+    // and the well is searched from there.
+
+    void setCusp(
+        const xt::xtensor<size_t, N>& I,
+        double K,
+        double G,
+        const Procedural& epsy,
+        const xt::xtensor<size_t, N>& index,
+        const xt::xtensor<double, N>& epsy_l,
+        const xt::xtensor<double, N + 2>& Eps);
+
+    void setSmooth(
+        const xt::xtensor<size_t, N>& I,
+        double K,
+        double G,
+        const Procedural& epsy,
+        const xt::xtensor<size_t, N>& index,
+        const xt::xtensor<double, N>& epsy_l,
+        const xt::xtensor<double, N + 2>& Eps);
+
     // Set parameters for a batch of points:
     // each to the same material, but with different parameters:
     // the matrix "idx" refers to a which entry to use: "K(idx)", "G(idx)", or "epsy(idx,:)"
@@ -253,9 +618,120 @@ public:
         const xt::xtensor<double, 2>& epsy,
         bool init_elastic = true);
 
+    // Idem, with the yield strains of landscape "j" given by "epsy(j)" (instead of "epsy(j, :)"),
+    // that is called in parallel for a bounded batch of landscapes at a time
+    // (no dense matrix of yield strains is needed)
+
+    using Landscape = std::function<xt::xtensor<double, 1>(size_t)>;
+
+    void setCusp(
+        const xt::xtensor<size_t, N>& I,
+        const xt::xtensor<size_t, N>& idx,
+        const xt::xtensor<double, 1>& K,
+        const xt::xtensor<double, 1>& G,
+        const Landscape& epsy,
+        bool init_elastic = true);
+
+    void setSmooth(
+        const xt::xtensor<size_t, N>& I,
+        const xt::xtensor<size_t, N>& idx,
+        const xt::xtensor<double, 1>& K,
+        const xt::xtensor<double, 1>& G,
+        const Landscape& epsy,
+        bool init_elastic = true);
+
+    // Idem, from (memory-mapped) files (see "Mapped"), without an intermediate copy
+    // (the yield strains are copied from the mapping to the landscape storage once):
+    // "I" and "idx" with the shape of the array, "K" and "G" with shape "[n]", "epsy" "[n, m]"
+
+    void setCusp(
+        const Mapped<size_t>& I,
+        const Mapped<size_t>& idx,
+        const Mapped<double>& K,
+        const Mapped<double>& G,
+        const Mapped<double>& epsy,
+        bool init_elastic = true);
+
+    void setSmooth(
+        const Mapped<size_t>& I,
+        const Mapped<size_t>& idx,
+        const Mapped<double>& K,
+        const Mapped<double>& G,
+        const Mapped<double>& epsy,
+        bool init_elastic = true);
+
     // Set strain tensor, get the response
 
     void setStrain(const xt::xtensor<double, N + 2>& arg);
+
+    // Fused update: set the strain and write the response of each point to caller-owned buffers
+    // in the same pass (row-major, with the shapes of "Stress", "Energy", "Epsp", and
+    // "CurrentIndex"; "nullptr" to skip)
+
+    void setStrain(
+        const xt::xtensor<double, N + 2>& arg,
+        xt::xtensor<double, N + 2>& sig,
+        xt::xtensor<double, N>& energy);
+
+    void setStrainPtr(
+        const double* Eps,
+        double* Sig,
+        double* energy = nullptr,
+        double* epsp = nullptr,
+        size_t* index = nullptr);
+
+    // Zero-copy mode: read the strain from, and write the stress to, caller-owned buffers
+    // (row-major, with the shape of "Strain"), that must stay alive while they are bound;
+    // no internal copy is kept. The current state is copied to the buffers on binding.
+    // "setStrain()" updates the response after writing the strain to the bound buffer.
+    // "unbindStorage" reverts to internal storage (the current state is copied back).
+
+    void bindStorage(S* Eps, S* Sig);
+    void bindStorage(xt::xtensor<S, N + 2>& Eps, xt::xtensor<S, N + 2>& Sig);
+    void unbindStorage();
+    bool isBound() const;
+    void setStrain();
+
+    // Symmetric storage: store the strain and stress as 6 Mandel components per point,
+    // "[xx, yy, zz, sqrt(2) yz, sqrt(2) xz, sqrt(2) xy]" (the current state is converted;
+    // "false" reverts to 9 components). The raw buffers of "setStrainPtr" and "bindStorage"
+    // are then in this format too (only), the "[..., 3, 3]" interface converts;
+    // "[..., 6]" input/output is available in all storage modes.
+
+    void setStorageMandel(bool mandel = true);
+    bool isStorageMandel() const;
+    void setStrainMandel(const xt::xtensor<double, N + 1>& arg);
+    void strainMandel(xt::xtensor<double, N + 1>& ret) const;
+    void stressMandel(xt::xtensor<double, N + 1>& ret) const;
+    xt::xtensor<double, N + 1> StrainMandel() const;
+    xt::xtensor<double, N + 1> StressMandel() const;
+
+    // Plane strain storage: store the strain and stress as "[xx, xy, yy, zz]" per point
+    // (the out-of-plane shear is zero, and ignored on input), and evaluate with reduced kernels;
+    // the result is identical to the "[..., 3, 3]" embedding. Otherwise as "setStorageMandel",
+    // with "[..., 4]" input/output in all storage modes.
+
+    void setStoragePlaneStrain(bool plane = true);
+    bool isStoragePlaneStrain() const;
+    void setStrainPlane(const xt::xtensor<double, N + 1>& arg);
+    void strainPlane(xt::xtensor<double, N + 1>& ret) const;
+    void stressPlane(xt::xtensor<double, N + 1>& ret) const;
+    xt::xtensor<double, N + 1> StrainPlane() const;
+    xt::xtensor<double, N + 1> StressPlane() const;
+
+    // Update a subset of points only: given by flat indices (unique), or by "I(i) == 1"
+    // ("arg" is the strain of all points, that of other points is ignored),
+    // get the response of a subset of points ("[index.size(), ...]")
+
+    void setStrainAt(const xt::xtensor<size_t, 1>& index, const xt::xtensor<double, N + 2>& arg);
+    void setStrainWhere(const xt::xtensor<size_t, N>& I, const xt::xtensor<double, N + 2>& arg);
+    void stressAt(const xt::xtensor<size_t, 1>& index, xt::xtensor<double, 3>& ret) const;
+    void energyAt(const xt::xtensor<size_t, 1>& index, xt::xtensor<double, 1>& ret) const;
+    xt::xtensor<double, 3> StressAt(const xt::xtensor<size_t, 1>& index) const;
+    xt::xtensor<double, 1> EnergyAt(const xt::xtensor<size_t, 1>& index) const;
+
+    // Get the response
+
     void strain(xt::xtensor<double, N + 2>& ret) const;
     void stress(xt::xtensor<double, N + 2>& ret) const;
     void tangent(xt::xtensor<double, N + 4>& ret) const;
@@ -266,6 +742,84 @@ public:
     bool checkYieldBoundRight(size_t n = 0) const;
     void epsp(xt::xtensor<double, N>& ret) const;
     void energy(xt::xtensor<double, N>& ret) const;
+    void epsd(xt::xtensor<double, N>& ret) const; // equivalent strain
+    void sigd(xt::xtensor<double, N>& ret) const; // equivalent stress
+
+    // Margin to the far-left/right: the minimal number of wells over all points, such that
+    // "checkYieldBoundLeft(n)" is true for any "n < yieldMarginLeft()" (idem right)
+    // (points without a bound, e.g. elastic points, are ignored; "npos" if no point is bounded).
+    // A point of which the equivalent strain is beyond its first (last) yield strain has no
+    // margin to the left (right): its response is that of the outermost well, but
+    // "checkYieldBoundLeft" ("...Right") fails.
+
+    size_t yieldMarginLeft() const;
+    size_t yieldMarginRight() const;
+
+    // Flat indices of the points for which "checkYieldBoundLeft(n)" ("...Right(n)") fails
+
+    xt::xtensor<size_t, 1> OffendersYieldBoundLeft(size_t n = 0) const;
+    xt::xtensor<size_t, 1> OffendersYieldBoundRight(size_t n = 0) const;
+
+    // Tangent without the 4th-order field: the tangent of each point is "K * II + 2 * G * I4d"
+    // - "tangentIsotropic": "[..., 2]" with "(K, G)" per point (zero for unset points)
+    // - "tangentDdot": "C : arg" for all points
+    // - "tangentVoigt" / "tangentMandel": "[..., 6, 6]" (see "detail::tangent_voigt")
+
+    void tangentIsotropic(xt::xtensor<double, N + 1>& ret) const;
+    void tangentDdot(const xt::xtensor<double, N + 2>& arg, xt::xtensor<double, N + 2>& ret) const;
+    void tangentVoigt(xt::xtensor<double, N + 2>& ret) const;
+    void tangentMandel(xt::xtensor<double, N + 2>& ret) const;
+
+    // Extend the stored landscapes of the points less than "n" wells from their far-right
+    // (those for which "checkYieldBoundRight(n)" fails): their yield strains are shifted to keep
+    // "n" wells left of the current well, and completed by
+    // "epsy[k + 1] = epsy[k] + increment(p, k)", with "p" the flat index of the point and "k" the
+    // index in its landscape (see "currentIndex"); "increment" is called in parallel.
+    // Points that share a landscape keep sharing it: it is extended once for all of them, with
+    // "p" the first of them and "n" wells kept left of the left-most of them (it is moved to a
+    // new slot only if it has to grow).
+    // Yield strains more than "n" wells left of the current well are discarded (the left margin,
+    // see "yieldMarginLeft", is then "n", while "currentIndex" is unchanged).
+    // Returns the number of extended points.
+
+    using Increment = std::function<double(size_t, size_t)>;
+
+    size_t extendYieldRight(size_t n, const Increment& increment);
+    size_t extendYieldRight(size_t n, const Procedural& increment);
+
+    // Call "extendYieldRight" automatically at the end of each "setStrain"
+    // ("nextended" returns the number of points extended by the last "setStrain")
+
+    void setYieldExtension(size_t n, const Increment& increment);
+    void setYieldExtension(size_t n, const Procedural& increment);
+    size_t nextended() const;
+
+    // Event-driven loading, for a strain "Eps + t * dEps" ("Eps" is the current strain):
+    // - "distanceToYield": per point, the smallest "t >= 0" at which the point reaches an edge
+    //   of its current well (infinity if it never does, e.g. for elastic points)
+    // - "minDistanceToYield": the minimum over all points, and the flat index of that point
+
+    void distanceToYield(const xt::xtensor<double, N + 2>& dEps, xt::xtensor<double, N>& ret) const;
+    xt::xtensor<double, N> DistanceToYield(const xt::xtensor<double, N + 2>& dEps) const;
+    std::pair<double, size_t> minDistanceToYield(const xt::xtensor<double, N + 2>& dEps) const;
+
+    // Record "yield events" in "setStrain" (off by default): the points of which "currentIndex"
+    // changed in the last "setStrain" (flat indices, sorted), and by how many wells (signed)
+
+    void setRecordEvents(bool record = true);
+    xt::xtensor<size_t, 1> EventPoints() const;
+    xt::xtensor<ptrdiff_t, 1> EventJumps() const;
+
+    // Checkpoint/restart: write/read the full state (type, parameters, landscapes, strain, stress,
+    // current wells) to/from a binary file (native byte order), with parallel I/O;
+    // "load" restores the state without recomputation (the shape of the array is that of the
+    // file). Settings ("setYieldExtension", "setRecordEvents") are not part of the state, and
+    // are kept; the storage is internal after "load" (see "bindStorage").
+    // "load" throws "std::runtime_error" if the file is not a valid checkpoint of this type of
+    // "Array" (on this byte order), in which case the array is unchanged.
+
+    void save(const std::string& filename) const;
+    void load(const std::string& filename);
 
     // Auto-allocation of the functions above
 
@@ -277,27 +831,233 @@ public:
     xt::xtensor<double, N> CurrentYieldRight() const;
     xt::xtensor<double, N> Epsp() const;
     xt::xtensor<double, N> Energy() const;
-
-    // Get copy or reference to the underlying model at on point
+    xt::xtensor<double, N> Epsd() const;
+    xt::xtensor<double, N> Sigd() const;
+    xt::xtensor<double, N + 1> TangentIsotropic() const;
+    xt::xtensor<double, N + 2> TangentDdot(const xt::xtensor<double, N + 2>& arg) const;
+    xt::xtensor<double, N + 2> TangentVoigt() const;
+    xt::xtensor<double, N + 2> TangentMandel() const;
+
+    // Get copy of the underlying model at on point (reconstructed from the current state).
+    // The copy has the stored yield strains: for a procedural or extended landscape these start
+    // at a well "shift > 0" of the full landscape, and "currentIndex()" of the copy is
+    // "CurrentIndex() - shift".
 
     auto getElastic(const std::array<size_t, N>& index) const;
     auto getCusp(const std::array<size_t, N>& index) const;
     auto getSmooth(const std::array<size_t, N>& index) const;
-    auto* refElastic(const std::array<size_t, N>& index);
-    auto* refCusp(const std::array<size_t, N>& index);
-    auto* refSmooth(const std::array<size_t, N>& index);
 
 private:
-    // Material vectors
-    std::vector<Elastic> m_Elastic;
-    std::vector<Cusp> m_Cusp;
-    std::vector<Smooth> m_Smooth;
+    // Caller-owned buffers of the fused update (see "setStrainPtr"), "nullptr" to skip
+    struct Output {
+        double* sig = nullptr;
+        double* energy = nullptr;
+        double* epsp = nullptr;
+        size_t* index = nullptr;
+        bool tensor = false; // write "sig" as "[3, 3]" tensors (converted from the storage format)
+    };
 
-    // Identifiers for each matrix entry
-    xt::xtensor<size_t, N> m_type;  // type (e.g. "Type::Elastic")
-    xt::xtensor<size_t, N> m_index; // index from the relevant material vector (e.g. "m_Elastic")
+    // Flat index of a point
+    size_t flat(const std::array<size_t, N>& index) const;
+
+    // Group the points by type (see "m_points") if the type of points changed since the last call
+    // (the setters only mark the groups as outdated)
+    void groupTypes() const;
+
+    // Call "f(i)" for each flat point "i" of type "type" (in parallel)
+    template <class F>
+    void forEach(size_t type, const F& f) const;
+
+    // Append a landscape to the arena, set for more than one point if "shared", returns its id
+    size_t addLandscape(const xt::xtensor<double, 1>& epsy, bool shared);
+
+    // Copy of a landscape
+    xt::xtensor<double, 1> landscape(size_t index) const;
+
+    // Store the landscapes "epsy(j)", "j < nrow", that are referenced by the selected points
+    // ("I[i] == 1", of which the row is "idx[i]"), each only once
+    // (returns the landscape id for each "j", unreferenced rows are skipped)
+    std::vector<size_t> addLandscapes(
+        const size_t* I,
+        const size_t* idx,
+        size_t nrow,
+        const Landscape& epsy,
+        bool init_elastic);
+
+    // Idem, for the rows of "epsy" "[nrow, m]" (copied from the mapping to the arena directly)
+    std::vector<size_t> addLandscapes(
+        const size_t* I,
+        const size_t* idx,
+        size_t nrow,
+        const Mapped<double>& epsy,
+        bool init_elastic);
+
+    // Rows "j < nrow" referenced by the selected points (see "addLandscapes"), and the number of
+    // points of each row in "used" (saturated at 2)
+    std::vector<size_t>
+    usedRows(const size_t* I, const size_t* idx, size_t nrow, std::vector<size_t>& used) const;
+
+    // Set points "I[i] == 1" to "type", with parameters "K[j]", "G[j]", and landscape "epsy(j)",
+    // with "j = idx[i] < nrow" (see "setCusp"; "epsy" is a "Landscape" or a "Mapped<double>")
+    template <class L>
+    void setLandscapes(
+        size_t type,
+        const size_t* I,
+        const size_t* idx,
+        const double* K,
+        const double* G,
+        size_t nrow,
+        const L& epsy,
+        bool init_elastic);
+
+    // Set points "I(i) == 1" to "type" with a procedural landscape (see "setCusp"),
+    // starting in well "start[i]" with left yield strain "start_epsy[i]", at strain
+    // "Eps[i, :, :]" (if not "nullptr", see "setCusp")
+    void setProcedural(
+        const xt::xtensor<size_t, N>& I,
+        size_t type,
+        double K,
+        double G,
+        const Procedural& epsy,
+        const size_t* start = nullptr,
+        const double* start_epsy = nullptr,
+        const double* Eps = nullptr);
+
+    // Generate the window of the procedural landscape of flat point "i", starting at "shift"
+    // (in "shift - m_shift(i)" increments from the current window, see "m_epsy0")
+    void setWindow(size_t i, size_t shift);
+
+    // Update the current yield index of flat (plastic) point "i" for an equivalent strain "epsd"
+    // (moves the window of a procedural landscape if needed)
+    void updateYieldIndex(size_t i, double epsd);
+
+    // Margin of flat point "i" to the far-left/right of its yield strains (see "yieldMarginLeft"),
+    // "npos" if it has no bound
+    size_t marginLeft(size_t i) const;
+    size_t marginRight(size_t i) const;
+
+    // Flat indices "i" for which "condition(i)" is true (sorted, evaluated in parallel)
+    template <class F>
+    std::vector<size_t> find(const F& condition) const;
+
+    // Indices "i < n" for which "condition(i)" is true (sorted, evaluated in parallel)
+    template <class F>
+    std::vector<size_t> find(size_t n, const F& condition) const;
+
+    // True if "condition(i)" is true for all flat indices "i" (evaluated in parallel)
+    template <class F>
+    bool allOf(const F& condition) const;
+
+    // Landscape extension (see "extendYieldRight"), the response of extended points is written
+    // to "out"; only the flat points "candidates" are checked (if not "nullptr", sorted)
+    size_t extend(
+        size_t n,
+        const Increment& increment,
+        const Output& out,
+        const std::vector<size_t>* candidates = nullptr);
+
+    // Contiguous blocks "(data, nbytes)" of the state, in the order of the checkpoint file
+    // (see "save"; the data are not changed when writing)
+    std::vector<std::pair<char*, size_t>> checkpoint() const;
+
+    // Change the storage format (see "Storage"), the current state is converted
+    void setStorage(size_t storage);
+
+    // All points of "arg" (stored as "format") in the storage format
+    // ("arg" itself if no conversion is needed, otherwise converted in "buffer")
+    const double* toStorage(const double* arg, size_t format, std::vector<double>& buffer) const;
+
+    // Convert all points of "B" (in the storage format) to "format"
+    template <class T>
+    void fromStorage(const S* B, size_t format, T* ret) const;
+
+    // Strain tensor of flat point "i" (converted in "buffer")
+    const double* strainTensor(size_t i, std::array<double, 9>& buffer) const;
+
+    // Strain/stress of flat point "i" (in internal or bound storage, in the storage format)
+    S* strainPtr(size_t i);
+    const S* strainPtr(size_t i) const;
+    S* stressPtr(size_t i);
+    const S* stressPtr(size_t i) const;
+
+    // Energy of flat point "i"
+    double pointEnergy(size_t i) const;
+
+    // Write the response of flat point "i" to "out"
+    void output(size_t i, const Output& out) const;
+
+    // Set the strain of all points, and write their response to "out"
+    // ("Eps" in the storage format, in "double" or in "S")
+    template <class E>
+    void update(const E* Eps, const Output& out);
+
+    // Set the strain of "n" points, given by their flat "index" ("Eps" of all points, in the
+    // storage format "format": only the selected points are read and converted)
+    void updateAt(const size_t* index, size_t n, const double* Eps, size_t format);
+
+    // Store the yield events from candidates "(i, index)" (see "update")
+    void storeEvents(std::vector<std::pair<size_t, size_t>>& events);
+
+    // Update the state of flat point "i" (of which the type is set) for a strain "Eps"
+    template <class E>
+    void setStrainPoint(size_t i, const E* Eps, const Output& out = Output());
+
+    // Update the state of "n <= detail::simd::block" points, given by their flat "index"
+    // (sorted), that are all of the same "type" (batched kernels; the points are gathered if
+    // they are not consecutive)
+    template <size_t type, class E>
+    void setStrainBlock(const size_t* index, size_t n, const E* Eps, const Output& out = Output());
+
+    // Material parameters, for each point ("structure of arrays")
+    xt::xtensor<size_t, N> m_type; // type (e.g. "Type::Elastic")
+    xt::xtensor<double, N> m_K;    // bulk modulus
+    xt::xtensor<double, N> m_G;    // shear modulus
+
+    // Flat indices of the points of each type (sorted), indexed by the type (e.g. "Type::Cusp"),
+    // valid if "m_grouped"
+    mutable std::array<std::vector<size_t>, 4> m_points;
+    mutable bool m_grouped = false;
+
+    // Potential energy landscapes (plastic points only), stored once and shared between points;
+    // the yield strains of all landscapes are stored contiguously ("arena")
+    std::vector<S> m_epsy;                 // yield strains of all landscapes
+    std::vector<size_t> m_epsy_offset;     // start of each landscape in "m_epsy"
+    std::vector<size_t> m_epsy_size;       // number of yield strains of each landscape
+    std::vector<size_t> m_epsy_procedural; // of each landscape: "m_procedural" entry or "npos"
+    std::vector<size_t> m_epsy_shared;     // of each landscape: set for more than one point
+    std::vector<Procedural> m_procedural;  // parameters of procedural landscapes
+    xt::xtensor<size_t, N> m_index;        // landscape of each point
+    xt::xtensor<size_t, N> m_shift;        // index of "epsy[0]" of each point in its landscape
+    xt::xtensor<double, N> m_epsy0;        // "epsy[0]" in "double" (procedural landscapes only)
+
+    // Automatic landscape extension (see "setYieldExtension")
+    size_t m_extend_n = 0;  // minimal number of wells to the far-right
+    Increment m_extend;     // increment of the yield strains (empty: no automatic extension)
+    size_t m_nextended = 0; // number of points extended by the last "setStrain"
+
+    // Yield events (see "setRecordEvents")
+    bool m_record = false;               // record events in "setStrain"
+    std::vector<size_t> m_event_point;   // flat index of each event
+    std::vector<ptrdiff_t> m_event_jump; // change of "currentIndex" of each event
+
+    // State, for each point
+    std::vector<S> m_Eps;               // strain tensor (empty if bound, see "bindStorage")
+    std::vector<S> m_Sig;               // stress tensor ,,
+    S* m_eps_bound = nullptr;           // bound strain buffer ("nullptr": internal storage)
+    S* m_sig_bound = nullptr;           // bound stress buffer ,,
+    size_t m_storage = Storage::Tensor; // storage format (see "Storage")
+    size_t m_stride_state = 9;          // number of components per point in storage
+    xt::xtensor<double, N> m_epsm;      // hydrostatic strain
+    xt::xtensor<double, N> m_epsd;      // equivalent strain
+    xt::xtensor<size_t, N> m_i;         // current yield index (in the stored yield strains)
+    xt::xtensor<S, N> m_epsy_l;         // current yield strain left: epsy[index]
+    xt::xtensor<S, N> m_epsy_r;         // current yield strain right: epsy[index + 1]
 
     // Shape
+    std::array<size_t, N + 1> m_shape_isotropic; // "[..., 2]" for "(K, G)"
+    std::array<size_t, N + 2> m_shape_matrix6;   // "[..., 6, 6]" for Voigt/Mandel
+    std::array<size_t, N + 1> m_shape_mandel;    // "[..., 6]" for Mandel
+    std::array<size_t, N + 1> m_shape_plane;     // "[..., 4]" for plane strain
     using GMatTensor::Cartesian3d::Array<N>::m_ndim;
     using GMatTensor::Cartesian3d::Array<N>::m_stride_tensor2;
     using GMatTensor::Cartesian3d::Array<N>::m_stride_tensor4;
@@ -314,6 +1074,7 @@ private:
 #include "Cartesian3d_Array.hpp"
 #include "Cartesian3d_Cusp.hpp"
 #include "Cartesian3d_Elastic.hpp"
+#include "Cartesian3d_Mapped.hpp"
 #include "Cartesian3d_Smooth.hpp"
 
 #endif
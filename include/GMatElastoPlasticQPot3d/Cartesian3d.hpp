@@ -7,6 +7,8 @@
 #ifndef GMATELASTOPLASTICQPOT3D_CARTESIAN3D_HPP
 #define GMATELASTOPLASTICQPOT3D_CARTESIAN3D_HPP
 
+#include <fstream>
+
 #include "Cartesian3d.h"
 
 namespace GMatElastoPlasticQPot3d {
@@ -38,6 +40,779 @@ inline auto Sigd(const T& A)
     return xt::eval(std::sqrt(2.0) * GMatTensor::Cartesian3d::Norm_deviatoric(A));
 }
 
+namespace detail {
+
+inline xt::xtensor<double, 1>
+yield_sequence(const xt::xtensor<double, 1>& epsy, bool init_elastic)
+{
+    xt::xtensor<double, 1> y = epsy;
+
+    if (!std::is_sorted(y.cbegin(), y.cend())) {
+        y = xt::sort(epsy);
+    }
+
+    if (init_elastic) {
+        if (y.size() < 2 || y(0) != -y(1)) {
+            y = xt::concatenate(xt::xtuple(xt::xtensor<double, 1>({-y(0)}), y));
+        }
+    }
+
+    GMATELASTOPLASTICQPOT3D_ASSERT(y.size() > 1);
+
+    return y;
+}
+
+inline size_t yield_sequence_prepend(const double* epsy, size_t n, bool init_elastic)
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(n > 1 || (n == 1 && init_elastic));
+
+    if (!init_elastic) {
+        return 0;
+    }
+
+    if (n < 2) {
+        return 1;
+    }
+
+    // the two smallest yield strains
+    double a = std::min(epsy[0], epsy[1]);
+    double b = std::max(epsy[0], epsy[1]);
+
+    for (size_t i = 2; i < n; ++i) {
+        if (epsy[i] < a) {
+            b = a;
+            a = epsy[i];
+        }
+        else if (epsy[i] < b) {
+            b = epsy[i];
+        }
+    }
+
+    return a != -b ? 1 : 0;
+}
+
+template <class T>
+inline void yield_sequence(const double* epsy, size_t n, size_t prepend, T* out)
+{
+    T* y = out + prepend;
+    std::copy(epsy, epsy + n, y);
+
+    if (!std::is_sorted(y, y + n)) {
+        std::sort(y, y + n);
+    }
+
+    if (prepend > 0) {
+        out[0] = -out[1];
+    }
+}
+
+template <class T>
+inline size_t yield_index(const T* epsy, size_t n, size_t i, double x)
+{
+    // still in the same well (most common)
+    if (epsy[i] < x && x <= epsy[i + 1]) {
+        return i;
+    }
+
+    // neighbouring wells
+    if (x > epsy[i + 1] && i + 2 < n) {
+        if (x <= epsy[i + 2]) {
+            return i + 1;
+        }
+    }
+    else if (x <= epsy[i] && i > 0) {
+        if (epsy[i - 1] < x) {
+            return i - 1;
+        }
+    }
+
+    // bisection
+    size_t j = std::lower_bound(epsy, epsy + n, x) - epsy;
+
+    if (j == 0) {
+        return 0;
+    }
+    if (j >= n) {
+        return n - 2;
+    }
+    return j - 1;
+}
+
+inline double random(uint64_t seed, uint64_t stream, uint64_t counter)
+{
+    // "splitmix64" finaliser, applied to the key and to both counters
+    auto mix = [](uint64_t z) {
+        z += 0x9e3779b97f4a7c15ull;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    };
+
+    uint64_t z = mix(mix(mix(seed) ^ stream) ^ counter);
+
+    return std::ldexp(static_cast<double>(z >> 11) + 0.5, -53);
+}
+
+inline double strain_decomposition(const double* Eps, double* Epsd, double& epsm)
+{
+    namespace GT = GMatTensor::Cartesian3d::pointer;
+    epsm = GT::Hydrostatic_deviatoric(Eps, Epsd);
+    return std::sqrt(0.5 * GT::A2s_ddot_B2s(Epsd, Epsd));
+}
+
+inline double
+distance_to_yield(const double* Eps, const double* dEps, double epsy_l, double epsy_r)
+{
+    namespace GT = GMatTensor::Cartesian3d::pointer;
+
+    // "2 * epsd^2 = a + 2 * c * t + b * t^2"
+    std::array<double, 9> A;
+    std::array<double, 9> B;
+    GT::Hydrostatic_deviatoric(Eps, &A[0]);
+    GT::Hydrostatic_deviatoric(dEps, &B[0]);
+    double a = GT::A2s_ddot_B2s(&A[0], &A[0]);
+    double b = GT::A2s_ddot_B2s(&B[0], &B[0]);
+    double c = GT::A2s_ddot_B2s(&A[0], &B[0]);
+    double ret = std::numeric_limits<double>::infinity();
+
+    if (b <= 0.0) {
+        return ret;
+    }
+
+    // right: one positive root
+    double d = c * c - b * (a - 2.0 * epsy_r * epsy_r);
+    if (d >= 0.0) {
+        ret = std::max(0.0, (-c + std::sqrt(d)) / b);
+    }
+
+    // left: only reached while decreasing (the smallest root)
+    if (epsy_l > 0.0 && c < 0.0) {
+        d = c * c - b * (a - 2.0 * epsy_l * epsy_l);
+        if (d >= 0.0) {
+            ret = std::min(ret, std::max(0.0, (-c - std::sqrt(d)) / b));
+        }
+    }
+
+    return ret;
+}
+
+template <class T>
+inline void stress(double K, double epsm, double g, const double* Epsd, T* Sig)
+{
+    Sig[0] = Sig[4] = Sig[8] = 3.0 * K * epsm;
+    Sig[0] += g * Epsd[0];
+    Sig[1] = g * Epsd[1];
+    Sig[2] = g * Epsd[2];
+    Sig[3] = g * Epsd[3];
+    Sig[4] += g * Epsd[4];
+    Sig[5] = g * Epsd[5];
+    Sig[6] = g * Epsd[6];
+    Sig[7] = g * Epsd[7];
+    Sig[8] += g * Epsd[8];
+}
+
+inline double g_elastic(double G)
+{
+    return 2.0 * G;
+}
+
+inline double g_cusp(double G, double epsd, double epsy_l, double epsy_r)
+{
+    if (epsd <= 0.0) {
+        return 0.0;
+    }
+
+    double eps_min = 0.5 * (epsy_r + epsy_l);
+
+    return 2.0 * G * (1.0 - eps_min / epsd);
+}
+
+inline double g_smooth(double G, double epsd, double epsy_l, double epsy_r)
+{
+    if (epsd <= 0.0) {
+        return 0.0;
+    }
+
+    double eps_min = 0.5 * (epsy_r + epsy_l);
+    double deps_y = 0.5 * (epsy_r - epsy_l);
+
+    return (2.0 * G / epsd) * (deps_y / M_PI) * sin(M_PI / deps_y * (epsd - eps_min));
+}
+
+constexpr Tensor4 II_data()
+{
+    Tensor4 ret{};
+
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            for (size_t k = 0; k < 3; ++k) {
+                for (size_t l = 0; l < 3; ++l) {
+                    ret.data[i * 27 + j * 9 + k * 3 + l] = (i == j && k == l) ? 1.0 : 0.0;
+                }
+            }
+        }
+    }
+
+    return ret;
+}
+
+constexpr Tensor4 I4d_data()
+{
+    Tensor4 ret{};
+
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            for (size_t k = 0; k < 3; ++k) {
+                for (size_t l = 0; l < 3; ++l) {
+                    double I4 = (i == l && j == k) ? 1.0 : 0.0;
+                    double I4rt = (i == k && j == l) ? 1.0 : 0.0;
+                    double II = (i == j && k == l) ? 1.0 : 0.0;
+                    ret.data[i * 27 + j * 9 + k * 3 + l] = 0.5 * (I4 + I4rt) - II / 3.0;
+                }
+            }
+        }
+    }
+
+    return ret;
+}
+
+template <class T>
+inline void tangent(double K, double G, T* C)
+{
+    static constexpr Tensor4 II = II_data();
+    static constexpr Tensor4 I4d = I4d_data();
+
+    for (size_t m = 0; m < 81; ++m) {
+        C[m] = K * II.data[m] + 2.0 * G * I4d.data[m];
+    }
+}
+
+template <class T>
+inline void tangent_ddot(double K, double G, const T* A, T* B)
+{
+    T tr = A[0] + A[4] + A[8];
+    T dev = 2.0 * G;
+    T vol = K * tr - dev * tr / 3.0;
+
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            B[i * 3 + j] = 0.5 * dev * (A[i * 3 + j] + A[j * 3 + i]);
+        }
+        B[i * 4] += vol;
+    }
+}
+
+template <class T>
+inline void tangent_voigt(double K, double G, T* C)
+{
+    std::fill(C, C + 36, T(0));
+
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            C[i * 6 + j] = K - 2.0 * G / 3.0;
+        }
+        C[i * 7] = K + 4.0 * G / 3.0;
+        C[(i + 3) * 7] = G;
+    }
+}
+
+template <class T>
+inline void tangent_mandel(double K, double G, T* C)
+{
+    tangent_voigt(K, G, C);
+
+    for (size_t i = 3; i < 6; ++i) {
+        C[i * 7] = 2.0 * G;
+    }
+}
+
+template <class T, class U>
+inline void to_mandel(const T* A, U* M)
+{
+    M[0] = A[0];
+    M[1] = A[4];
+    M[2] = A[8];
+    M[3] = std::sqrt(2.0) * A[5];
+    M[4] = std::sqrt(2.0) * A[2];
+    M[5] = std::sqrt(2.0) * A[1];
+}
+
+template <class T, class U>
+inline void from_mandel(const T* M, U* A)
+{
+    A[0] = M[0];
+    A[4] = M[1];
+    A[8] = M[2];
+    A[5] = A[7] = M[3] / std::sqrt(2.0);
+    A[2] = A[6] = M[4] / std::sqrt(2.0);
+    A[1] = A[3] = M[5] / std::sqrt(2.0);
+}
+
+template <class T, class U>
+inline void to_plane(const T* A, U* P)
+{
+    P[0] = A[0];
+    P[1] = A[1];
+    P[2] = A[4];
+    P[3] = A[8];
+}
+
+template <class T, class U>
+inline void from_plane(const T* P, U* A)
+{
+    A[0] = P[0];
+    A[1] = A[3] = P[1];
+    A[4] = P[2];
+    A[8] = P[3];
+    A[2] = A[5] = A[6] = A[7] = U(0);
+}
+
+inline size_t storage_size(size_t storage)
+{
+    switch (storage) {
+    case Storage::Mandel:
+        return 6;
+    case Storage::PlaneStrain:
+        return 4;
+    }
+
+    return 9;
+}
+
+template <class T, class U>
+inline void to_storage(size_t storage, const T* A, U* B)
+{
+    switch (storage) {
+    case Storage::Mandel:
+        return to_mandel(A, B);
+    case Storage::PlaneStrain:
+        return to_plane(A, B);
+    }
+
+    std::copy(A, A + 9, B);
+}
+
+template <class T, class U>
+inline void from_storage(size_t storage, const T* B, U* A)
+{
+    switch (storage) {
+    case Storage::Mandel:
+        return from_mandel(B, A);
+    case Storage::PlaneStrain:
+        return from_plane(B, A);
+    }
+
+    std::copy(B, B + 9, A);
+}
+
+inline double energy_elastic(double K, double G, double epsm, double epsd)
+{
+    return 3.0 * K * std::pow(epsm, 2.0) + 2.0 * G * std::pow(epsd, 2.0);
+}
+
+inline double energy_cusp(
+    double K,
+    double G,
+    double epsm,
+    double epsd,
+    double epsy_l,
+    double epsy_r)
+{
+    double U = 3.0 * K * std::pow(epsm, 2.0);
+
+    double eps_min = 0.5 * (epsy_r + epsy_l);
+    double deps_y = 0.5 * (epsy_r - epsy_l);
+
+    double V = 2.0 * G * (std::pow(epsd - eps_min, 2.0) - std::pow(deps_y, 2.0));
+
+    return U + V;
+}
+
+inline double energy_smooth(
+    double K,
+    double G,
+    double epsm,
+    double epsd,
+    double epsy_l,
+    double epsy_r)
+{
+    double U = 3.0 * K * std::pow(epsm, 2.0);
+
+    double eps_min = 0.5 * (epsy_r + epsy_l);
+    double deps_y = 0.5 * (epsy_r - epsy_l);
+
+    double V
+        = -4.0 * G * std::pow(deps_y / M_PI, 2.0)
+        * (1.0 + cos(M_PI / deps_y * (epsd - eps_min)));
+
+    return U + V;
+}
+
+namespace simd {
+
+#ifdef XTENSOR_USE_XSIMD
+
+inline batch load(const double* arg)
+{
+    return xsimd::load_unaligned(arg);
+}
+
+inline void store(double* ret, const batch& arg)
+{
+    xsimd::store_unaligned(ret, arg);
+}
+
+using xsimd::select;
+
+#else
+
+inline batch load(const double* arg)
+{
+    return *arg;
+}
+
+inline void store(double* ret, const batch& arg)
+{
+    *ret = arg;
+}
+
+inline batch select(bool cond, const batch& a, const batch& b)
+{
+    return cond ? a : b;
+}
+
+#endif
+
+} // namespace simd
+
+template <class T>
+inline void strain_decomposition(const T* Eps, size_t n, Block& b, size_t storage)
+{
+    using std::sqrt;
+    using simd::batch;
+
+    if (storage == Storage::PlaneStrain) {
+        return strain_decomposition_plane(Eps, n, b);
+    }
+
+    GMATELASTOPLASTICQPOT3D_ASSERT(n <= simd::block);
+
+    std::array<std::array<double, simd::block>, 9> E;
+    std::array<double, 9> A;
+    size_t stride = storage_size(storage);
+
+    for (size_t p = 0; p < n; ++p) {
+        if (storage == Storage::Tensor) {
+            for (size_t c = 0; c < 9; ++c) {
+                E[c][p] = Eps[p * 9 + c];
+            }
+        }
+        else {
+            from_storage(storage, &Eps[p * stride], &A[0]);
+            for (size_t c = 0; c < 9; ++c) {
+                E[c][p] = A[c];
+            }
+        }
+    }
+
+    for (size_t p = n; p < simd::block; ++p) {
+        for (size_t c = 0; c < 9; ++c) {
+            E[c][p] = 0.0;
+        }
+        b.K[p] = 0.0;
+        b.G[p] = 0.0;
+        b.epsy_l[p] = -1.0;
+        b.epsy_r[p] = 1.0;
+    }
+
+    for (size_t p = 0; p < simd::block; p += simd::size) {
+        batch xx = simd::load(&E[0][p]);
+        batch xy = simd::load(&E[1][p]);
+        batch xz = simd::load(&E[2][p]);
+        batch yx = simd::load(&E[3][p]);
+        batch yy = simd::load(&E[4][p]);
+        batch yz = simd::load(&E[5][p]);
+        batch zx = simd::load(&E[6][p]);
+        batch zy = simd::load(&E[7][p]);
+        batch zz = simd::load(&E[8][p]);
+
+        batch epsm = (xx + yy + zz) / batch(3.0);
+        xx = xx - epsm;
+        yy = yy - epsm;
+        zz = zz - epsm;
+
+        batch ddot = xx * xx + yy * yy + zz * zz + batch(2.0) * (xy * xy + xz * xz + yz * yz);
+
+        simd::store(&b.epsm[p], epsm);
+        simd::store(&b.epsd[p], sqrt(batch(0.5) * ddot));
+        simd::store(&b.Epsd[0][p], xx);
+        simd::store(&b.Epsd[1][p], xy);
+        simd::store(&b.Epsd[2][p], xz);
+        simd::store(&b.Epsd[3][p], yx);
+        simd::store(&b.Epsd[4][p], yy);
+        simd::store(&b.Epsd[5][p], yz);
+        simd::store(&b.Epsd[6][p], zx);
+        simd::store(&b.Epsd[7][p], zy);
+        simd::store(&b.Epsd[8][p], zz);
+    }
+}
+
+template <class T>
+inline void strain_decomposition_plane(const T* Eps, size_t n, Block& b)
+{
+    using std::sqrt;
+    using simd::batch;
+
+    GMATELASTOPLASTICQPOT3D_ASSERT(n <= simd::block);
+
+    std::array<std::array<double, simd::block>, 4> E;
+
+    for (size_t p = 0; p < n; ++p) {
+        for (size_t c = 0; c < 4; ++c) {
+            E[c][p] = Eps[p * 4 + c];
+        }
+    }
+
+    for (size_t p = n; p < simd::block; ++p) {
+        for (size_t c = 0; c < 4; ++c) {
+            E[c][p] = 0.0;
+        }
+        b.K[p] = 0.0;
+        b.G[p] = 0.0;
+        b.epsy_l[p] = -1.0;
+        b.epsy_r[p] = 1.0;
+    }
+
+    for (size_t p = 0; p < simd::block; p += simd::size) {
+        batch xx = simd::load(&E[0][p]);
+        batch xy = simd::load(&E[1][p]);
+        batch yy = simd::load(&E[2][p]);
+        batch zz = simd::load(&E[3][p]);
+
+        batch epsm = (xx + yy + zz) / batch(3.0);
+        xx = xx - epsm;
+        yy = yy - epsm;
+        zz = zz - epsm;
+
+        batch ddot = xx * xx + yy * yy + zz * zz + batch(2.0) * (xy * xy);
+
+        simd::store(&b.epsm[p], epsm);
+        simd::store(&b.epsd[p], sqrt(batch(0.5) * ddot));
+        simd::store(&b.Epsd[0][p], xx);
+        simd::store(&b.Epsd[1][p], xy);
+        simd::store(&b.Epsd[4][p], yy);
+        simd::store(&b.Epsd[8][p], zz);
+    }
+}
+
+inline void g_elastic(Block& b)
+{
+    using simd::batch;
+
+    for (size_t p = 0; p < simd::block; p += simd::size) {
+        simd::store(&b.g[p], batch(2.0) * simd::load(&b.G[p]));
+    }
+}
+
+inline void g_cusp(Block& b)
+{
+    using simd::batch;
+    using simd::select;
+
+    for (size_t p = 0; p < simd::block; p += simd::size) {
+        batch G = simd::load(&b.G[p]);
+        batch epsd = simd::load(&b.epsd[p]);
+        batch eps_min = batch(0.5) * (simd::load(&b.epsy_r[p]) + simd::load(&b.epsy_l[p]));
+        batch zero = batch(0.0);
+        auto elastic = epsd <= zero;
+        batch x = select(elastic, batch(1.0), epsd);
+        batch g = batch(2.0) * G * (batch(1.0) - eps_min / x);
+        simd::store(&b.g[p], select(elastic, zero, g));
+    }
+}
+
+inline void g_smooth(Block& b)
+{
+    using std::sin;
+    using simd::batch;
+    using simd::select;
+
+    for (size_t p = 0; p < simd::block; p += simd::size) {
+        batch G = simd::load(&b.G[p]);
+        batch epsd = simd::load(&b.epsd[p]);
+        batch epsy_l = simd::load(&b.epsy_l[p]);
+        batch epsy_r = simd::load(&b.epsy_r[p]);
+        batch eps_min = batch(0.5) * (epsy_r + epsy_l);
+        batch deps_y = batch(0.5) * (epsy_r - epsy_l);
+        batch zero = batch(0.0);
+        batch pi = batch(M_PI);
+        auto elastic = epsd <= zero;
+        batch x = select(elastic, batch(1.0), epsd);
+        batch g = (batch(2.0) * G / x) * (deps_y / pi) * sin(pi / deps_y * (x - eps_min));
+        simd::store(&b.g[p], select(elastic, zero, g));
+    }
+}
+
+template <class T>
+inline void stress(const Block& b, size_t n, T* Sig, size_t storage)
+{
+    using simd::batch;
+
+    if (storage == Storage::PlaneStrain) {
+        return stress_plane(b, n, Sig);
+    }
+
+    GMATELASTOPLASTICQPOT3D_ASSERT(n <= simd::block);
+
+    std::array<std::array<double, simd::block>, 9> S;
+
+    for (size_t p = 0; p < simd::block; p += simd::size) {
+        batch g = simd::load(&b.g[p]);
+        batch s = batch(3.0) * simd::load(&b.K[p]) * simd::load(&b.epsm[p]);
+        for (size_t c = 0; c < 9; ++c) {
+            simd::store(&S[c][p], g * simd::load(&b.Epsd[c][p]));
+        }
+        simd::store(&S[0][p], s + simd::load(&S[0][p]));
+        simd::store(&S[4][p], s + simd::load(&S[4][p]));
+        simd::store(&S[8][p], s + simd::load(&S[8][p]));
+    }
+
+    std::array<double, 9> A;
+    size_t stride = storage_size(storage);
+
+    for (size_t p = 0; p < n; ++p) {
+        if (storage == Storage::Tensor) {
+            for (size_t c = 0; c < 9; ++c) {
+                Sig[p * 9 + c] = S[c][p];
+            }
+        }
+        else {
+            for (size_t c = 0; c < 9; ++c) {
+                A[c] = S[c][p];
+            }
+            to_storage(storage, &A[0], &Sig[p * stride]);
+        }
+    }
+}
+
+template <class T>
+inline void stress_plane(const Block& b, size_t n, T* Sig)
+{
+    using simd::batch;
+
+    GMATELASTOPLASTICQPOT3D_ASSERT(n <= simd::block);
+
+    std::array<std::array<double, simd::block>, 4> S;
+
+    for (size_t p = 0; p < simd::block; p += simd::size) {
+        batch g = simd::load(&b.g[p]);
+        batch s = batch(3.0) * simd::load(&b.K[p]) * simd::load(&b.epsm[p]);
+        simd::store(&S[0][p], s + g * simd::load(&b.Epsd[0][p]));
+        simd::store(&S[1][p], g * simd::load(&b.Epsd[1][p]));
+        simd::store(&S[2][p], s + g * simd::load(&b.Epsd[4][p]));
+        simd::store(&S[3][p], s + g * simd::load(&b.Epsd[8][p]));
+    }
+
+    for (size_t p = 0; p < n; ++p) {
+        for (size_t c = 0; c < 4; ++c) {
+            Sig[p * 4 + c] = S[c][p];
+        }
+    }
+}
+
+inline bool parallel_io(
+    const std::string& filename,
+    const std::vector<std::pair<char*, size_t>>& blocks,
+    size_t offset,
+    bool write)
+{
+    // chunks "(position in file, data, nbytes)"
+    std::vector<std::tuple<size_t, char*, size_t>> chunks;
+
+    for (auto& block : blocks) {
+        for (size_t i = 0; i < block.second; i += io_chunk) {
+            chunks.emplace_back(offset + i, block.first + i, std::min(io_chunk, block.second - i));
+        }
+        offset += block.second;
+    }
+
+    int failed = 0;
+
+    #pragma omp parallel
+    {
+        auto mode = write ? std::ios::in | std::ios::out : std::ios::in;
+        std::fstream file(filename, mode | std::ios::binary);
+
+        #pragma omp for schedule(dynamic)
+        for (size_t c = 0; c < chunks.size(); ++c) {
+            size_t position = std::get<0>(chunks[c]);
+            char* data = std::get<1>(chunks[c]);
+            size_t n = std::get<2>(chunks[c]);
+
+            if (write) {
+                file.seekp(position);
+                file.write(data, n);
+            }
+            else {
+                file.seekg(position);
+                file.read(data, n);
+            }
+
+            if (!file) {
+                #pragma omp atomic write
+                failed = 1;
+            }
+        }
+    }
+
+    return failed == 0;
+}
+
+inline uint64_t bits(double x)
+{
+    static_assert(sizeof(double) == sizeof(uint64_t), "64-bit double assumed");
+    uint64_t ret;
+    std::memcpy(&ret, &x, sizeof(ret));
+    return ret;
+}
+
+inline double from_bits(uint64_t x)
+{
+    double ret;
+    std::memcpy(&ret, &x, sizeof(ret));
+    return ret;
+}
+
+} // namespace detail
+
+inline Procedural::Procedural(
+    Distribution distribution,
+    double a,
+    double b,
+    double offset,
+    uint64_t seed,
+    size_t window)
+    : distribution(distribution), a(a), b(b), offset(offset), seed(seed), window(window)
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(window >= 4);
+}
+
+inline double Procedural::increment(size_t p, size_t n) const
+{
+    double u = detail::random(seed, p, n);
+
+    switch (distribution) {
+    case Weibull:
+        return offset + b * std::pow(-std::log(1.0 - u), 1.0 / a);
+    case Uniform:
+        return offset + a + (b - a) * u;
+    case Delta:
+        return offset + a;
+    }
+
+    return offset + a;
+}
+
 } // namespace Cartesian3d
 } // namespace GMatElastoPlasticQPot3d
 
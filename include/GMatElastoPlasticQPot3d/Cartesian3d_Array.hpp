@@ -7,312 +7,582 @@
 #ifndef GMATELASTOPLASTICQPOT3D_CARTESIAN3D_MATRIX_HPP
 #define GMATELASTOPLASTICQPOT3D_CARTESIAN3D_MATRIX_HPP
 
+#include <fstream>
+
 #include "Cartesian3d.h"
 
 namespace GMatElastoPlasticQPot3d {
 namespace Cartesian3d {
 
-template <size_t N>
-inline Array<N>::Array(const std::array<size_t, N>& shape)
+template <size_t N, class S>
+inline Array<N, S>::Array(const std::array<size_t, N>& shape)
 {
     this->init(shape);
     m_type = xt::ones<size_t>(m_shape) * Type::Unset;
-    m_index = xt::empty<size_t>(m_shape);
+    m_K = xt::zeros<double>(m_shape);
+    m_G = xt::zeros<double>(m_shape);
+    m_index = xt::zeros<size_t>(m_shape);
+    m_shift = xt::zeros<size_t>(m_shape);
+    m_epsy0 = xt::zeros<double>(m_shape);
+    m_Eps.assign(m_size * m_stride_tensor2, 0.0);
+    m_Sig.assign(m_size * m_stride_tensor2, 0.0);
+    m_epsm = xt::zeros<double>(m_shape);
+    m_epsd = xt::zeros<double>(m_shape);
+    m_i = xt::zeros<size_t>(m_shape);
+    m_epsy_l = xt::zeros<S>(m_shape);
+    m_epsy_r = xt::zeros<S>(m_shape);
+    std::copy(m_shape.cbegin(), m_shape.cend(), m_shape_isotropic.begin());
+    std::copy(m_shape.cbegin(), m_shape.cend(), m_shape_matrix6.begin());
+    std::copy(m_shape.cbegin(), m_shape.cend(), m_shape_mandel.begin());
+    std::copy(m_shape.cbegin(), m_shape.cend(), m_shape_plane.begin());
+    m_shape_isotropic[N] = 2;
+    m_shape_mandel[N] = 6;
+    m_shape_plane[N] = 4;
+    m_shape_matrix6[N] = 6;
+    m_shape_matrix6[N + 1] = 6;
 }
 
-template <size_t N>
-inline xt::xtensor<double, N> Array<N>::K() const
+template <size_t N, class S>
+inline size_t Array<N, S>::flat(const std::array<size_t, N>& index) const
 {
-    xt::xtensor<double, N> ret = xt::empty<double>(m_shape);
+    size_t i = 0;
+
+    for (size_t d = 0; d < N; ++d) {
+        GMATELASTOPLASTICQPOT3D_ASSERT(index[d] < m_shape[d]);
+        i = i * m_shape[d] + index[d];
+    }
+
+    return i;
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::groupTypes() const
+{
+    if (m_grouped) {
+        return;
+    }
+
+    // count the points of each type per chunk, and write them at the offset of their chunk
+    // (the points of each type stay sorted)
+    size_t nchunk = (m_size + detail::group_chunk - 1) / detail::group_chunk;
+    std::vector<std::array<size_t, 4>> offset(nchunk);
 
     #pragma omp parallel for
-    for (size_t i = 0; i < m_size; ++i) {
-        switch (m_type.data()[i]) {
-        case Type::Unset:
-            ret.data()[i] = 0.0;
-            break;
-        case Type::Elastic:
-            ret.data()[i] = m_Elastic[m_index.data()[i]].K();
-            break;
-        case Type::Cusp:
-            ret.data()[i] = m_Cusp[m_index.data()[i]].K();
-            break;
-        case Type::Smooth:
-            ret.data()[i] = m_Smooth[m_index.data()[i]].K();
-            break;
+    for (size_t c = 0; c < nchunk; ++c) {
+        offset[c].fill(0);
+        size_t end = std::min(m_size, (c + 1) * detail::group_chunk);
+        for (size_t i = c * detail::group_chunk; i < end; ++i) {
+            offset[c][m_type.data()[i]]++;
         }
     }
 
-    return ret;
+    for (size_t type = 0; type < m_points.size(); ++type) {
+        size_t n = 0;
+        for (size_t c = 0; c < nchunk; ++c) {
+            size_t count = offset[c][type];
+            offset[c][type] = n;
+            n += count;
+        }
+        m_points[type].resize(n);
+    }
+
+    #pragma omp parallel for
+    for (size_t c = 0; c < nchunk; ++c) {
+        std::array<size_t, 4>& k = offset[c];
+        size_t end = std::min(m_size, (c + 1) * detail::group_chunk);
+        for (size_t i = c * detail::group_chunk; i < end; ++i) {
+            size_t type = m_type.data()[i];
+            m_points[type][k[type]++] = i;
+        }
+    }
+
+    m_grouped = true;
 }
 
-template <size_t N>
-inline xt::xtensor<double, N> Array<N>::G() const
+template <size_t N, class S>
+template <class F>
+inline void Array<N, S>::forEach(size_t type, const F& f) const
 {
-    xt::xtensor<double, N> ret = xt::empty<double>(m_shape);
+    this->groupTypes();
+    const std::vector<size_t>& points = m_points[type];
 
     #pragma omp parallel for
-    for (size_t i = 0; i < m_size; ++i) {
-        switch (m_type.data()[i]) {
-        case Type::Unset:
-            ret.data()[i] = 0.0;
-            break;
-        case Type::Elastic:
-            ret.data()[i] = m_Elastic[m_index.data()[i]].G();
-            break;
-        case Type::Cusp:
-            ret.data()[i] = m_Cusp[m_index.data()[i]].G();
-            break;
-        case Type::Smooth:
-            ret.data()[i] = m_Smooth[m_index.data()[i]].G();
-            break;
+    for (size_t p = 0; p < points.size(); ++p) {
+        f(points[p]);
+    }
+}
+
+template <size_t N, class S>
+inline xt::xtensor<double, N> Array<N, S>::K() const
+{
+    return m_K;
+}
+
+template <size_t N, class S>
+inline xt::xtensor<double, N> Array<N, S>::G() const
+{
+    return m_G;
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::currentIndex(xt::xtensor<size_t, N>& ret) const
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape));
+
+    auto zero = [&](size_t i) { ret.data()[i] = 0; };
+    auto plastic = [&](size_t i) { ret.data()[i] = m_shift.data()[i] + m_i.data()[i]; };
+
+    this->forEach(Type::Unset, zero);
+    this->forEach(Type::Elastic, zero);
+    this->forEach(Type::Cusp, plastic);
+    this->forEach(Type::Smooth, plastic);
+}
+
+template <size_t N, class S>
+inline size_t Array<N, S>::marginLeft(size_t i) const
+{
+    size_t type = m_type.data()[i];
+
+    if (type != Type::Cusp && type != Type::Smooth) {
+        return detail::npos;
+    }
+
+    // beyond the first yield strain (the yield index is clipped)
+    if (m_epsd.data()[i] <= m_epsy_l.data()[i]) {
+        return 0;
+    }
+
+    // procedural landscape: wells left of the window are regenerated when needed,
+    // otherwise only the stored wells count (wells may have been discarded by "extendYieldRight")
+    if (m_epsy_procedural[m_index.data()[i]] != detail::npos) {
+        return m_shift.data()[i] + m_i.data()[i];
+    }
+
+    return m_i.data()[i];
+}
+
+template <size_t N, class S>
+inline size_t Array<N, S>::marginRight(size_t i) const
+{
+    size_t type = m_type.data()[i];
+
+    if (type != Type::Cusp && type != Type::Smooth) {
+        return detail::npos;
+    }
+
+    // beyond the last yield strain (the yield index is clipped)
+    if (m_epsd.data()[i] > m_epsy_r.data()[i]) {
+        return 0;
+    }
+
+    size_t l = m_index.data()[i];
+
+    if (m_epsy_procedural[l] != detail::npos) {
+        return detail::npos;
+    }
+
+    return m_epsy_size[l] - 1 - m_i.data()[i];
+}
+
+template <size_t N, class S>
+template <class F>
+inline std::vector<size_t> Array<N, S>::find(const F& condition) const
+{
+    return this->find(m_size, condition);
+}
+
+template <size_t N, class S>
+template <class F>
+inline std::vector<size_t> Array<N, S>::find(size_t n, const F& condition) const
+{
+    std::vector<size_t> ret;
+
+    #pragma omp parallel
+    {
+        std::vector<size_t> local;
+
+        #pragma omp for nowait
+        for (size_t i = 0; i < n; ++i) {
+            if (condition(i)) {
+                local.push_back(i);
+            }
         }
+
+        #pragma omp critical
+        ret.insert(ret.end(), local.cbegin(), local.cend());
     }
 
+    std::sort(ret.begin(), ret.end());
+
     return ret;
 }
 
-template <size_t N>
-inline void Array<N>::currentIndex(xt::xtensor<size_t, N>& ret) const
+template <size_t N, class S>
+template <class F>
+inline bool Array<N, S>::allOf(const F& condition) const
 {
-    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape));
+    bool ret = true;
 
-    #pragma omp parallel for
+    #pragma omp parallel for reduction(&& : ret)
     for (size_t i = 0; i < m_size; ++i) {
-        switch (m_type.data()[i]) {
-        case Type::Unset:
-            ret.data()[i] = 0;
-            break;
-        case Type::Elastic:
-            ret.data()[i] = 0;
-            break;
-        case Type::Cusp:
-            ret.data()[i] = m_Cusp[m_index.data()[i]].currentIndex();
-            break;
-        case Type::Smooth:
-            ret.data()[i] = m_Smooth[m_index.data()[i]].currentIndex();
-            break;
-        }
+        ret = ret && condition(i);
     }
+
+    return ret;
 }
 
-template <size_t N>
-inline bool Array<N>::checkYieldBoundLeft(size_t n) const
+template <size_t N, class S>
+inline bool Array<N, S>::checkYieldBoundLeft(size_t n) const
 {
+    bool ret = true;
 
-    #pragma omp parallel for
+    #pragma omp parallel for reduction(&& : ret)
     for (size_t i = 0; i < m_size; ++i) {
-        switch (m_type.data()[i]) {
-        case Type::Unset:
-            break;
-        case Type::Elastic:
-            break;
-        case Type::Cusp:
-            if (!m_Cusp[m_index.data()[i]].checkYieldBoundLeft(n)) {
-                return false;
-            }
-            break;
-        case Type::Smooth:
-            if (!m_Smooth[m_index.data()[i]].checkYieldBoundLeft(n)) {
-                return false;
-            }
-            break;
-        }
+        ret = ret && n < this->marginLeft(i);
     }
 
-    return true;
+    return ret;
 }
 
-template <size_t N>
-inline bool Array<N>::checkYieldBoundRight(size_t n) const
+template <size_t N, class S>
+inline bool Array<N, S>::checkYieldBoundRight(size_t n) const
 {
+    bool ret = true;
 
-    #pragma omp parallel for
+    #pragma omp parallel for reduction(&& : ret)
     for (size_t i = 0; i < m_size; ++i) {
-        switch (m_type.data()[i]) {
-        case Type::Unset:
-            break;
-        case Type::Elastic:
-            break;
-        case Type::Cusp:
-            if (!m_Cusp[m_index.data()[i]].checkYieldBoundRight(n)) {
-                return false;
-            }
-            break;
-        case Type::Smooth:
-            if (!m_Smooth[m_index.data()[i]].checkYieldBoundRight(n)) {
-                return false;
-            }
-            break;
-        }
+        ret = ret && n < this->marginRight(i);
     }
 
-    return true;
+    return ret;
 }
 
-template <size_t N>
-inline void Array<N>::currentYieldLeft(xt::xtensor<double, N>& ret) const
+template <size_t N, class S>
+inline size_t Array<N, S>::yieldMarginLeft() const
 {
-    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape));
+    size_t ret = detail::npos;
 
-    #pragma omp parallel for
+    #pragma omp parallel for reduction(min : ret)
     for (size_t i = 0; i < m_size; ++i) {
-        switch (m_type.data()[i]) {
-        case Type::Unset:
-            ret.data()[i] = 0.0;
-            break;
-        case Type::Elastic:
-            ret.data()[i] = std::numeric_limits<double>::infinity();
-            break;
-        case Type::Cusp:
-            ret.data()[i] = m_Cusp[m_index.data()[i]].currentYieldLeft();
-            break;
-        case Type::Smooth:
-            ret.data()[i] = m_Smooth[m_index.data()[i]].currentYieldLeft();
-            break;
-        }
+        ret = std::min(ret, this->marginLeft(i));
     }
+
+    return ret;
 }
 
-template <size_t N>
-inline void Array<N>::currentYieldRight(xt::xtensor<double, N>& ret) const
+template <size_t N, class S>
+inline size_t Array<N, S>::yieldMarginRight() const
 {
-    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape));
+    size_t ret = detail::npos;
 
-    #pragma omp parallel for
+    #pragma omp parallel for reduction(min : ret)
     for (size_t i = 0; i < m_size; ++i) {
-        switch (m_type.data()[i]) {
-        case Type::Unset:
-            ret.data()[i] = 0.0;
-            break;
-        case Type::Elastic:
-            ret.data()[i] = std::numeric_limits<double>::infinity();
-            break;
-        case Type::Cusp:
-            ret.data()[i] = m_Cusp[m_index.data()[i]].currentYieldRight();
-            break;
-        case Type::Smooth:
-            ret.data()[i] = m_Smooth[m_index.data()[i]].currentYieldRight();
-            break;
-        }
+        ret = std::min(ret, this->marginRight(i));
     }
+
+    return ret;
+}
+
+template <size_t N, class S>
+inline xt::xtensor<size_t, 1> Array<N, S>::OffendersYieldBoundLeft(size_t n) const
+{
+    std::vector<size_t> index = this->find([&](size_t i) { return !(n < this->marginLeft(i)); });
+    std::array<size_t, 1> shape = {index.size()};
+    xt::xtensor<size_t, 1> ret = xt::empty<size_t>(shape);
+    std::copy(index.cbegin(), index.cend(), ret.begin());
+    return ret;
+}
+
+template <size_t N, class S>
+inline xt::xtensor<size_t, 1> Array<N, S>::OffendersYieldBoundRight(size_t n) const
+{
+    std::vector<size_t> index = this->find([&](size_t i) { return !(n < this->marginRight(i)); });
+    std::array<size_t, 1> shape = {index.size()};
+    xt::xtensor<size_t, 1> ret = xt::empty<size_t>(shape);
+    std::copy(index.cbegin(), index.cend(), ret.begin());
+    return ret;
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::currentYieldLeft(xt::xtensor<double, N>& ret) const
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape));
+
+    auto elastic = [&](size_t i) { ret.data()[i] = std::numeric_limits<double>::infinity(); };
+    auto plastic = [&](size_t i) { ret.data()[i] = m_epsy_l.data()[i]; };
+
+    this->forEach(Type::Unset, [&](size_t i) { ret.data()[i] = 0.0; });
+    this->forEach(Type::Elastic, elastic);
+    this->forEach(Type::Cusp, plastic);
+    this->forEach(Type::Smooth, plastic);
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::currentYieldRight(xt::xtensor<double, N>& ret) const
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape));
+
+    auto elastic = [&](size_t i) { ret.data()[i] = std::numeric_limits<double>::infinity(); };
+    auto plastic = [&](size_t i) { ret.data()[i] = m_epsy_r.data()[i]; };
+
+    this->forEach(Type::Unset, [&](size_t i) { ret.data()[i] = 0.0; });
+    this->forEach(Type::Elastic, elastic);
+    this->forEach(Type::Cusp, plastic);
+    this->forEach(Type::Smooth, plastic);
 }
 
-template <size_t N>
-inline void Array<N>::epsp(xt::xtensor<double, N>& ret) const
+template <size_t N, class S>
+inline void Array<N, S>::epsp(xt::xtensor<double, N>& ret) const
 {
     GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape));
 
+    auto zero = [&](size_t i) { ret.data()[i] = 0.0; };
+    auto plastic = [&](size_t i) {
+        ret.data()[i] = 0.5 * (m_epsy_l.data()[i] + m_epsy_r.data()[i]);
+    };
+
+    this->forEach(Type::Unset, zero);
+    this->forEach(Type::Elastic, zero);
+    this->forEach(Type::Cusp, plastic);
+    this->forEach(Type::Smooth, plastic);
+}
+
+template <size_t N, class S>
+inline const double*
+Array<N, S>::toStorage(const double* arg, size_t format, std::vector<double>& buffer) const
+{
+    if (format == m_storage) {
+        return arg;
+    }
+
+    size_t stride = detail::storage_size(format);
+    buffer.resize(m_size * m_stride_state);
+
     #pragma omp parallel for
     for (size_t i = 0; i < m_size; ++i) {
-        switch (m_type.data()[i]) {
-        case Type::Unset:
-            ret.data()[i] = 0.0;
-            break;
-        case Type::Elastic:
-            ret.data()[i] = 0.0;
-            break;
-        case Type::Cusp:
-            ret.data()[i] = m_Cusp[m_index.data()[i]].epsp();
-            break;
-        case Type::Smooth:
-            ret.data()[i] = m_Smooth[m_index.data()[i]].epsp();
-            break;
-        }
+        std::array<double, 9> A;
+        detail::from_storage(format, &arg[i * stride], &A[0]);
+        detail::to_storage(m_storage, &A[0], &buffer[i * m_stride_state]);
     }
+
+    return buffer.data();
 }
 
-template <size_t N>
-inline void Array<N>::energy(xt::xtensor<double, N>& ret) const
+template <size_t N, class S>
+template <class T>
+inline void Array<N, S>::fromStorage(const S* B, size_t format, T* ret) const
 {
-    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape));
+    if (format == m_storage) {
+        std::copy(B, B + m_size * m_stride_state, ret);
+        return;
+    }
+
+    size_t stride = detail::storage_size(format);
 
     #pragma omp parallel for
     for (size_t i = 0; i < m_size; ++i) {
-        switch (m_type.data()[i]) {
-        case Type::Unset:
-            ret.data()[i] = 0.0;
-            break;
-        case Type::Elastic:
-            ret.data()[i] = m_Elastic[m_index.data()[i]].energy();
-            break;
-        case Type::Cusp:
-            ret.data()[i] = m_Cusp[m_index.data()[i]].energy();
-            break;
-        case Type::Smooth:
-            ret.data()[i] = m_Smooth[m_index.data()[i]].energy();
-            break;
-        }
+        std::array<double, 9> A;
+        detail::from_storage(m_storage, &B[i * m_stride_state], &A[0]);
+        detail::to_storage(format, &A[0], &ret[i * stride]);
+    }
+}
+
+template <size_t N, class S>
+inline const double* Array<N, S>::strainTensor(size_t i, std::array<double, 9>& buffer) const
+{
+    detail::from_storage(m_storage, this->strainPtr(i), &buffer[0]);
+    return &buffer[0];
+}
+
+template <size_t N, class S>
+inline S* Array<N, S>::strainPtr(size_t i)
+{
+    S* eps = m_eps_bound ? m_eps_bound : m_Eps.data();
+    return &eps[i * m_stride_state];
+}
+
+template <size_t N, class S>
+inline const S* Array<N, S>::strainPtr(size_t i) const
+{
+    const S* eps = m_eps_bound ? m_eps_bound : m_Eps.data();
+    return &eps[i * m_stride_state];
+}
+
+template <size_t N, class S>
+inline S* Array<N, S>::stressPtr(size_t i)
+{
+    S* sig = m_sig_bound ? m_sig_bound : m_Sig.data();
+    return &sig[i * m_stride_state];
+}
+
+template <size_t N, class S>
+inline const S* Array<N, S>::stressPtr(size_t i) const
+{
+    const S* sig = m_sig_bound ? m_sig_bound : m_Sig.data();
+    return &sig[i * m_stride_state];
+}
+
+template <size_t N, class S>
+inline double Array<N, S>::pointEnergy(size_t i) const
+{
+    double K = m_K.data()[i];
+    double G = m_G.data()[i];
+    double epsm = m_epsm.data()[i];
+    double epsd = m_epsd.data()[i];
+
+    switch (m_type.data()[i]) {
+    case Type::Elastic:
+        return detail::energy_elastic(K, G, epsm, epsd);
+    case Type::Cusp:
+        return detail::energy_cusp(K, G, epsm, epsd, m_epsy_l.data()[i], m_epsy_r.data()[i]);
+    case Type::Smooth:
+        return detail::energy_smooth(K, G, epsm, epsd, m_epsy_l.data()[i], m_epsy_r.data()[i]);
     }
+
+    return 0.0;
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::energy(xt::xtensor<double, N>& ret) const
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape));
+
+    this->forEach(Type::Unset, [&](size_t i) { ret.data()[i] = 0.0; });
+
+    this->forEach(Type::Elastic, [&](size_t i) {
+        ret.data()[i] = detail::energy_elastic(
+            m_K.data()[i], m_G.data()[i], m_epsm.data()[i], m_epsd.data()[i]);
+    });
+
+    this->forEach(Type::Cusp, [&](size_t i) {
+        ret.data()[i] = detail::energy_cusp(
+            m_K.data()[i],
+            m_G.data()[i],
+            m_epsm.data()[i],
+            m_epsd.data()[i],
+            m_epsy_l.data()[i],
+            m_epsy_r.data()[i]);
+    });
+
+    this->forEach(Type::Smooth, [&](size_t i) {
+        ret.data()[i] = detail::energy_smooth(
+            m_K.data()[i],
+            m_G.data()[i],
+            m_epsm.data()[i],
+            m_epsd.data()[i],
+            m_epsy_l.data()[i],
+            m_epsy_r.data()[i]);
+    });
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::epsd(xt::xtensor<double, N>& ret) const
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape));
+    std::copy(m_epsd.cbegin(), m_epsd.cend(), ret.begin());
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::sigd(xt::xtensor<double, N>& ret) const
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape));
+
+    // "Sigd = g * Epsd", whereby "sigd = 2 * |g| * epsd"
+
+    this->forEach(Type::Unset, [&](size_t i) { ret.data()[i] = 0.0; });
+
+    this->forEach(Type::Elastic, [&](size_t i) {
+        double g = detail::g_elastic(m_G.data()[i]);
+        ret.data()[i] = 2.0 * std::abs(g) * m_epsd.data()[i];
+    });
+
+    this->forEach(Type::Cusp, [&](size_t i) {
+        double epsd = m_epsd.data()[i];
+        double g = detail::g_cusp(m_G.data()[i], epsd, m_epsy_l.data()[i], m_epsy_r.data()[i]);
+        ret.data()[i] = 2.0 * std::abs(g) * epsd;
+    });
+
+    this->forEach(Type::Smooth, [&](size_t i) {
+        double epsd = m_epsd.data()[i];
+        double g = detail::g_smooth(m_G.data()[i], epsd, m_epsy_l.data()[i], m_epsy_r.data()[i]);
+        ret.data()[i] = 2.0 * std::abs(g) * epsd;
+    });
 }
 
-template <size_t N>
-inline xt::xtensor<size_t, N> Array<N>::type() const
+template <size_t N, class S>
+inline xt::xtensor<size_t, N> Array<N, S>::type() const
 {
     return m_type;
 }
 
-template <size_t N>
-inline xt::xtensor<size_t, N> Array<N>::isElastic() const
+template <size_t N, class S>
+inline xt::xtensor<size_t, N> Array<N, S>::isElastic() const
 {
     xt::xtensor<size_t, N> ret = xt::where(xt::equal(m_type, Type::Elastic), 1ul, 0ul);
     return ret;
 }
 
-template <size_t N>
-inline xt::xtensor<size_t, N> Array<N>::isPlastic() const
+template <size_t N, class S>
+inline xt::xtensor<size_t, N> Array<N, S>::isPlastic() const
 {
     xt::xtensor<size_t, N> ret = xt::where(xt::not_equal(m_type, Type::Elastic), 1ul, 0ul);
     return ret;
 }
 
-template <size_t N>
-inline xt::xtensor<size_t, N> Array<N>::isCusp() const
+template <size_t N, class S>
+inline xt::xtensor<size_t, N> Array<N, S>::isCusp() const
 {
     xt::xtensor<size_t, N> ret = xt::where(xt::equal(m_type, Type::Cusp), 1ul, 0ul);
     return ret;
 }
 
-template <size_t N>
-inline xt::xtensor<size_t, N> Array<N>::isSmooth() const
+template <size_t N, class S>
+inline xt::xtensor<size_t, N> Array<N, S>::isSmooth() const
 {
     xt::xtensor<size_t, N> ret = xt::where(xt::equal(m_type, Type::Cusp), 1ul, 0ul);
     return ret;
 }
 
-template <size_t N>
-inline void Array<N>::setElastic(const xt::xtensor<double, N>& K, const xt::xtensor<double, N>& G)
+template <size_t N, class S>
+inline void
+Array<N, S>::setElastic(const xt::xtensor<double, N>& K, const xt::xtensor<double, N>& G)
 {
     GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(m_type, K.shape()));
     GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(m_type, G.shape()));
     GMATELASTOPLASTICQPOT3D_ASSERT(xt::all(xt::equal(m_type, m_type)));
 
+    #pragma omp parallel for
     for (size_t i = 0; i < m_size; ++i) {
         m_type.data()[i] = Type::Elastic;
-        m_index.data()[i] = m_Elastic.size();
-        m_Elastic.push_back(Elastic(K.data()[i], G.data()[i]));
+        m_K.data()[i] = K.data()[i];
+        m_G.data()[i] = G.data()[i];
     }
+
+    m_grouped = false;
 }
 
-template <size_t N>
-inline void Array<N>::setElastic(const xt::xtensor<size_t, N>& I, double K, double G)
+template <size_t N, class S>
+inline void Array<N, S>::setElastic(const xt::xtensor<size_t, N>& I, double K, double G)
 {
     GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(m_type, I.shape()));
     GMATELASTOPLASTICQPOT3D_ASSERT(xt::all(xt::equal(I, 0ul) || xt::equal(I, 1ul)));
     GMATELASTOPLASTICQPOT3D_ASSERT(
         xt::all(xt::equal(xt::where(xt::equal(I, 1ul), m_type, Type::Unset), Type::Unset)));
 
+    #pragma omp parallel for
     for (size_t i = 0; i < m_size; ++i) {
         if (I.data()[i] == 1ul) {
             m_type.data()[i] = Type::Elastic;
-            m_index.data()[i] = m_Elastic.size();
-            m_Elastic.push_back(Elastic(K, G));
+            m_K.data()[i] = K;
+            m_G.data()[i] = G;
         }
     }
+
+    m_grouped = false;
 }
 
-template <size_t N>
-inline void Array<N>::setCusp(
+template <size_t N, class S>
+inline void Array<N, S>::setCusp(
     const xt::xtensor<size_t, N>& I,
     double K,
     double G,
@@ -324,17 +594,25 @@ inline void Array<N>::setCusp(
     GMATELASTOPLASTICQPOT3D_ASSERT(
         xt::all(xt::equal(xt::where(xt::equal(I, 1ul), m_type, Type::Unset), Type::Unset)));
 
+    bool shared = xt::sum(I)() > 1;
+    size_t index = this->addLandscape(detail::yield_sequence(epsy, init_elastic), shared);
+
+    #pragma omp parallel for
     for (size_t i = 0; i < m_size; ++i) {
         if (I.data()[i] == 1ul) {
             m_type.data()[i] = Type::Cusp;
-            m_index.data()[i] = m_Cusp.size();
-            m_Cusp.push_back(Cusp(K, G, epsy, init_elastic));
+            m_K.data()[i] = K;
+            m_G.data()[i] = G;
+            m_index.data()[i] = index;
+            this->setStrainPoint(i, this->strainPtr(i));
         }
     }
+
+    m_grouped = false;
 }
 
-template <size_t N>
-inline void Array<N>::setSmooth(
+template <size_t N, class S>
+inline void Array<N, S>::setSmooth(
     const xt::xtensor<size_t, N>& I,
     double K,
     double G,
@@ -346,17 +624,25 @@ inline void Array<N>::setSmooth(
     GMATELASTOPLASTICQPOT3D_ASSERT(
         xt::all(xt::equal(xt::where(xt::equal(I, 1ul), m_type, Type::Unset), Type::Unset)));
 
+    bool shared = xt::sum(I)() > 1;
+    size_t index = this->addLandscape(detail::yield_sequence(epsy, init_elastic), shared);
+
+    #pragma omp parallel for
     for (size_t i = 0; i < m_size; ++i) {
         if (I.data()[i] == 1ul) {
             m_type.data()[i] = Type::Smooth;
-            m_index.data()[i] = m_Smooth.size();
-            m_Smooth.push_back(Smooth(K, G, epsy, init_elastic));
+            m_K.data()[i] = K;
+            m_G.data()[i] = G;
+            m_index.data()[i] = index;
+            this->setStrainPoint(i, this->strainPtr(i));
         }
     }
+
+    m_grouped = false;
 }
 
-template <size_t N>
-inline void Array<N>::setElastic(
+template <size_t N, class S>
+inline void Array<N, S>::setElastic(
     const xt::xtensor<size_t, N>& I,
     const xt::xtensor<size_t, N>& idx,
     const xt::xtensor<double, 1>& K,
@@ -370,271 +656,1811 @@ inline void Array<N>::setElastic(
     GMATELASTOPLASTICQPOT3D_ASSERT(
         xt::all(xt::equal(xt::where(xt::equal(I, 1ul), m_type, Type::Unset), Type::Unset)));
 
+    #pragma omp parallel for
     for (size_t i = 0; i < m_size; ++i) {
         if (I.data()[i] == 1ul) {
             size_t j = idx.data()[i];
             m_type.data()[i] = Type::Elastic;
-            m_index.data()[i] = m_Elastic.size();
-            m_Elastic.push_back(Elastic(K(j), G(j)));
+            m_K.data()[i] = K(j);
+            m_G.data()[i] = G(j);
         }
     }
+
+    m_grouped = false;
 }
 
-template <size_t N>
-inline void Array<N>::setCusp(
+template <size_t N, class S>
+inline void Array<N, S>::setCusp(
     const xt::xtensor<size_t, N>& I,
     const xt::xtensor<size_t, N>& idx,
     const xt::xtensor<double, 1>& K,
     const xt::xtensor<double, 1>& G,
     const xt::xtensor<double, 2>& epsy,
     bool init_elastic)
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(K.size() == epsy.shape(0));
+
+    auto row = [&](size_t j) -> xt::xtensor<double, 1> { return xt::view(epsy, j, xt::all()); };
+    this->setCusp(I, idx, K, G, Landscape(row), init_elastic);
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::setCusp(
+    const xt::xtensor<size_t, N>& I,
+    const xt::xtensor<size_t, N>& idx,
+    const xt::xtensor<double, 1>& K,
+    const xt::xtensor<double, 1>& G,
+    const Landscape& epsy,
+    bool init_elastic)
 {
     GMATELASTOPLASTICQPOT3D_ASSERT(xt::amax(idx)() == K.size() - 1);
     GMATELASTOPLASTICQPOT3D_ASSERT(K.size() == G.size());
-    GMATELASTOPLASTICQPOT3D_ASSERT(K.size() == epsy.shape(0));
     GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(m_type, I.shape()));
     GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(m_type, idx.shape()));
-    GMATELASTOPLASTICQPOT3D_ASSERT(xt::all(xt::equal(I, 0ul) || xt::equal(I, 1ul)));
+
+    this->setLandscapes(
+        Type::Cusp, I.data(), idx.data(), K.data(), G.data(), K.size(), epsy, init_elastic);
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::setCusp(
+    const Mapped<size_t>& I,
+    const Mapped<size_t>& idx,
+    const Mapped<double>& K,
+    const Mapped<double>& G,
+    const Mapped<double>& epsy,
+    bool init_elastic)
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(K.shape().size() == 1);
+    GMATELASTOPLASTICQPOT3D_ASSERT(K.shape() == G.shape());
+    GMATELASTOPLASTICQPOT3D_ASSERT(epsy.shape().size() == 2);
+    GMATELASTOPLASTICQPOT3D_ASSERT(epsy.shape()[0] == K.size());
     GMATELASTOPLASTICQPOT3D_ASSERT(
-        xt::all(xt::equal(xt::where(xt::equal(I, 1ul), m_type, Type::Unset), Type::Unset)));
+        I.shape() == std::vector<size_t>(m_shape.cbegin(), m_shape.cend()));
+    GMATELASTOPLASTICQPOT3D_ASSERT(I.shape() == idx.shape());
 
-    for (size_t i = 0; i < m_size; ++i) {
-        if (I.data()[i] == 1ul) {
-            size_t j = idx.data()[i];
-            m_type.data()[i] = Type::Cusp;
-            m_index.data()[i] = m_Cusp.size();
-            m_Cusp.push_back(Cusp(K(j), G(j), xt::view(epsy, j, xt::all()), init_elastic));
-        }
-    }
+    this->setLandscapes(
+        Type::Cusp, I.data(), idx.data(), K.data(), G.data(), K.size(), epsy, init_elastic);
 }
 
-template <size_t N>
-inline void Array<N>::setSmooth(
+template <size_t N, class S>
+inline void Array<N, S>::setSmooth(
     const xt::xtensor<size_t, N>& I,
     const xt::xtensor<size_t, N>& idx,
     const xt::xtensor<double, 1>& K,
     const xt::xtensor<double, 1>& G,
     const xt::xtensor<double, 2>& epsy,
     bool init_elastic)
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(K.size() == epsy.shape(0));
+
+    auto row = [&](size_t j) -> xt::xtensor<double, 1> { return xt::view(epsy, j, xt::all()); };
+    this->setSmooth(I, idx, K, G, Landscape(row), init_elastic);
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::setSmooth(
+    const xt::xtensor<size_t, N>& I,
+    const xt::xtensor<size_t, N>& idx,
+    const xt::xtensor<double, 1>& K,
+    const xt::xtensor<double, 1>& G,
+    const Landscape& epsy,
+    bool init_elastic)
 {
     GMATELASTOPLASTICQPOT3D_ASSERT(xt::amax(idx)() == K.size() - 1);
     GMATELASTOPLASTICQPOT3D_ASSERT(K.size() == G.size());
-    GMATELASTOPLASTICQPOT3D_ASSERT(K.size() == epsy.shape(0));
     GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(m_type, I.shape()));
     GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(m_type, idx.shape()));
-    GMATELASTOPLASTICQPOT3D_ASSERT(xt::all(xt::equal(I, 0ul) || xt::equal(I, 1ul)));
-    GMATELASTOPLASTICQPOT3D_ASSERT(
-        xt::all(xt::equal(xt::where(xt::equal(I, 1ul), m_type, Type::Unset), Type::Unset)));
 
-    for (size_t i = 0; i < m_size; ++i) {
-        if (I.data()[i] == 1ul) {
-            size_t j = idx.data()[i];
-            m_type.data()[i] = Type::Smooth;
-            m_index.data()[i] = m_Smooth.size();
-            m_Smooth.push_back(Smooth(K(j), G(j), xt::view(epsy, j, xt::all()), init_elastic));
-        }
-    }
+    this->setLandscapes(
+        Type::Smooth, I.data(), idx.data(), K.data(), G.data(), K.size(), epsy, init_elastic);
 }
 
-template <size_t N>
-inline void Array<N>::setStrain(const xt::xtensor<double, N + 2>& arg)
+template <size_t N, class S>
+inline void Array<N, S>::setSmooth(
+    const Mapped<size_t>& I,
+    const Mapped<size_t>& idx,
+    const Mapped<double>& K,
+    const Mapped<double>& G,
+    const Mapped<double>& epsy,
+    bool init_elastic)
 {
-    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(arg, m_shape_tensor2));
+    GMATELASTOPLASTICQPOT3D_ASSERT(K.shape().size() == 1);
+    GMATELASTOPLASTICQPOT3D_ASSERT(K.shape() == G.shape());
+    GMATELASTOPLASTICQPOT3D_ASSERT(epsy.shape().size() == 2);
+    GMATELASTOPLASTICQPOT3D_ASSERT(epsy.shape()[0] == K.size());
+    GMATELASTOPLASTICQPOT3D_ASSERT(
+        I.shape() == std::vector<size_t>(m_shape.cbegin(), m_shape.cend()));
+    GMATELASTOPLASTICQPOT3D_ASSERT(I.shape() == idx.shape());
 
-    #pragma omp parallel for
-    for (size_t i = 0; i < m_size; ++i) {
-        switch (m_type.data()[i]) {
-        case Type::Unset:
-            break;
-        case Type::Elastic:
-            m_Elastic[m_index.data()[i]].setStrainPtr(&arg.data()[i * m_stride_tensor2]);
-            break;
-        case Type::Cusp:
-            m_Cusp[m_index.data()[i]].setStrainPtr(&arg.data()[i * m_stride_tensor2]);
-            break;
-        case Type::Smooth:
-            m_Smooth[m_index.data()[i]].setStrainPtr(&arg.data()[i * m_stride_tensor2]);
-            break;
-        }
-    }
+    this->setLandscapes(
+        Type::Smooth, I.data(), idx.data(), K.data(), G.data(), K.size(), epsy, init_elastic);
 }
 
-template <size_t N>
-inline void Array<N>::strain(xt::xtensor<double, N + 2>& ret) const
+template <size_t N, class S>
+inline size_t Array<N, S>::addLandscape(const xt::xtensor<double, 1>& epsy, bool shared)
 {
-    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape_tensor2));
+    size_t index = m_epsy_offset.size();
+    m_epsy_offset.push_back(m_epsy.size());
+    m_epsy_size.push_back(epsy.size());
+    m_epsy_procedural.push_back(detail::npos);
+    m_epsy_shared.push_back(shared);
+    m_epsy.insert(m_epsy.end(), epsy.cbegin(), epsy.cend());
+    return index;
+}
 
-    #pragma omp parallel for
-    for (size_t i = 0; i < m_size; ++i) {
-        switch (m_type.data()[i]) {
-        case Type::Unset:
-            GMatTensor::Cartesian3d::pointer::O2(&ret.data()[i * m_stride_tensor2]);
-            break;
-        case Type::Elastic:
-            m_Elastic[m_index.data()[i]].strainPtr(&ret.data()[i * m_stride_tensor2]);
-            break;
-        case Type::Cusp:
-            m_Cusp[m_index.data()[i]].strainPtr(&ret.data()[i * m_stride_tensor2]);
-            break;
-        case Type::Smooth:
-            m_Smooth[m_index.data()[i]].strainPtr(&ret.data()[i * m_stride_tensor2]);
-            break;
-        }
-    }
+template <size_t N, class S>
+inline xt::xtensor<double, 1> Array<N, S>::landscape(size_t index) const
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(index < m_epsy_offset.size());
+    std::array<size_t, 1> shape = {m_epsy_size[index]};
+    xt::xtensor<double, 1> ret = xt::empty<double>(shape);
+    auto begin = m_epsy.cbegin() + m_epsy_offset[index];
+    std::copy(begin, begin + m_epsy_size[index], ret.begin());
+    return ret;
 }
 
-template <size_t N>
-inline void Array<N>::stress(xt::xtensor<double, N + 2>& ret) const
+template <size_t N, class S>
+template <class L>
+inline void Array<N, S>::setLandscapes(
+    size_t type,
+    const size_t* I,
+    const size_t* idx,
+    const double* K,
+    const double* G,
+    size_t nrow,
+    const L& epsy,
+    bool init_elastic)
 {
-    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape_tensor2));
+    GMATELASTOPLASTICQPOT3D_ASSERT(this->allOf([&](size_t i) {
+        return I[i] == 0ul || (I[i] == 1ul && m_type.data()[i] == Type::Unset && idx[i] < nrow);
+    }));
+
+    std::vector<size_t> index = this->addLandscapes(I, idx, nrow, epsy, init_elastic);
 
     #pragma omp parallel for
     for (size_t i = 0; i < m_size; ++i) {
-        switch (m_type.data()[i]) {
-        case Type::Unset:
-            GMatTensor::Cartesian3d::pointer::O2(&ret.data()[i * m_stride_tensor2]);
-            break;
-        case Type::Elastic:
-            m_Elastic[m_index.data()[i]].stressPtr(&ret.data()[i * m_stride_tensor2]);
-            break;
-        case Type::Cusp:
-            m_Cusp[m_index.data()[i]].stressPtr(&ret.data()[i * m_stride_tensor2]);
-            break;
-        case Type::Smooth:
-            m_Smooth[m_index.data()[i]].stressPtr(&ret.data()[i * m_stride_tensor2]);
-            break;
+        if (I[i] == 1ul) {
+            size_t j = idx[i];
+            m_type.data()[i] = type;
+            m_K.data()[i] = K[j];
+            m_G.data()[i] = G[j];
+            m_index.data()[i] = index[j];
+            this->setStrainPoint(i, this->strainPtr(i));
         }
     }
+
+    m_grouped = false;
 }
 
-template <size_t N>
-inline void Array<N>::tangent(xt::xtensor<double, N + 4>& ret) const
+template <size_t N, class S>
+inline std::vector<size_t> Array<N, S>::addLandscapes(
+    const size_t* I,
+    const size_t* idx,
+    size_t nrow,
+    const Landscape& epsy,
+    bool init_elastic)
 {
-    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape_tensor4));
+    std::vector<size_t> index(nrow, nrow);
+    std::vector<size_t> used;
+    std::vector<size_t> rows = this->usedRows(I, idx, nrow, used);
 
-    #pragma omp parallel for
-    for (size_t i = 0; i < m_size; ++i) {
-        switch (m_type.data()[i]) {
-        case Type::Unset:
-            GMatTensor::Cartesian3d::pointer::O4(&ret.data()[i * m_stride_tensor4]);
-            break;
-        case Type::Elastic:
-            m_Elastic[m_index.data()[i]].tangentPtr(&ret.data()[i * m_stride_tensor4]);
-            break;
-        case Type::Cusp:
-            m_Cusp[m_index.data()[i]].tangentPtr(&ret.data()[i * m_stride_tensor4]);
-            break;
-        case Type::Smooth:
-            m_Smooth[m_index.data()[i]].tangentPtr(&ret.data()[i * m_stride_tensor4]);
-            break;
+    // per batch of rows: generate and sort (if needed) in parallel, then copy to the arena
+    // in parallel (only one batch is held in memory at a time)
+
+    std::vector<xt::xtensor<double, 1>> y(std::min(detail::landscape_batch, rows.size()));
+
+    for (size_t start = 0; start < rows.size(); start += detail::landscape_batch) {
+
+        size_t n = std::min(detail::landscape_batch, rows.size() - start);
+
+        #pragma omp parallel for
+        for (size_t k = 0; k < n; ++k) {
+            y[k] = detail::yield_sequence(epsy(rows[start + k]), init_elastic);
+        }
+
+        size_t landscape = m_epsy_offset.size();
+        size_t offset = m_epsy.size();
+
+        for (size_t k = 0; k < n; ++k) {
+            index[rows[start + k]] = m_epsy_offset.size();
+            m_epsy_offset.push_back(offset);
+            m_epsy_size.push_back(y[k].size());
+            m_epsy_procedural.push_back(detail::npos);
+            m_epsy_shared.push_back(used[rows[start + k]] > 1);
+            offset += y[k].size();
+        }
+
+        m_epsy.resize(offset);
+
+        #pragma omp parallel for
+        for (size_t k = 0; k < n; ++k) {
+            std::copy(y[k].cbegin(), y[k].cend(), m_epsy.begin() + m_epsy_offset[landscape + k]);
         }
     }
+
+    return index;
 }
 
-template <size_t N>
-inline xt::xtensor<double, N + 2> Array<N>::Strain() const
+template <size_t N, class S>
+inline std::vector<size_t> Array<N, S>::addLandscapes(
+    const size_t* I,
+    const size_t* idx,
+    size_t nrow,
+    const Mapped<double>& epsy,
+    bool init_elastic)
+{
+    std::vector<size_t> index(nrow, nrow);
+    std::vector<size_t> used;
+    std::vector<size_t> rows = this->usedRows(I, idx, nrow, used);
+
+    size_t ncol = epsy.shape()[1];
+    size_t n = rows.size();
+    size_t landscape = m_epsy_offset.size();
+    m_epsy_offset.resize(landscape + n);
+    m_epsy_size.resize(landscape + n);
+    m_epsy_procedural.resize(landscape + n, detail::npos);
+    m_epsy_shared.resize(landscape + n);
+
+    #pragma omp parallel for
+    for (size_t k = 0; k < n; ++k) {
+        const double* y = epsy.data() + rows[k] * ncol;
+        m_epsy_size[landscape + k] = ncol + detail::yield_sequence_prepend(y, ncol, init_elastic);
+    }
+
+    size_t offset = m_epsy.size();
+
+    for (size_t k = 0; k < n; ++k) {
+        index[rows[k]] = landscape + k;
+        m_epsy_offset[landscape + k] = offset;
+        m_epsy_shared[landscape + k] = used[rows[k]] > 1;
+        offset += m_epsy_size[landscape + k];
+    }
+
+    m_epsy.resize(offset);
+
+    #pragma omp parallel for
+    for (size_t k = 0; k < n; ++k) {
+        detail::yield_sequence(
+            epsy.data() + rows[k] * ncol,
+            ncol,
+            m_epsy_size[landscape + k] - ncol,
+            &m_epsy[m_epsy_offset[landscape + k]]);
+    }
+
+    return index;
+}
+
+template <size_t N, class S>
+inline std::vector<size_t> Array<N, S>::usedRows(
+    const size_t* I,
+    const size_t* idx,
+    size_t nrow,
+    std::vector<size_t>& used) const
+{
+    used.assign(nrow, 0);
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < m_size; ++i) {
+        if (I[i] == 1ul) {
+            size_t& u = used[idx[i]];
+            size_t c;
+            #pragma omp atomic read
+            c = u;
+            if (c < 2) {
+                #pragma omp atomic
+                u++;
+            }
+        }
+    }
+
+    return this->find(nrow, [&](size_t j) { return used[j] > 0; });
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::setProcedural(
+    const xt::xtensor<size_t, N>& I,
+    size_t type,
+    double K,
+    double G,
+    const Procedural& epsy,
+    const size_t* start,
+    const double* start_epsy,
+    const double* Eps)
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(m_type, I.shape()));
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::all(xt::equal(I, 0ul) || xt::equal(I, 1ul)));
+    GMATELASTOPLASTICQPOT3D_ASSERT(
+        xt::all(xt::equal(xt::where(xt::equal(I, 1ul), m_type, Type::Unset), Type::Unset)));
+    GMATELASTOPLASTICQPOT3D_ASSERT(epsy.window >= 4);
+
+    // warm start: the strain lies in the given well, "epsy_l < epsd <= epsy_l + increment"
+    GMATELASTOPLASTICQPOT3D_ASSERT(!start_epsy || !Eps || this->allOf([&](size_t i) {
+        if (I.data()[i] != 1ul) {
+            return true;
+        }
+        std::array<double, 9> Epsd;
+        double epsm;
+        double epsd = detail::strain_decomposition(&Eps[i * m_stride_tensor2], &Epsd[0], epsm);
+        double epsy_l = start_epsy[i];
+        return epsy_l < epsd && epsd <= epsy_l + epsy.increment(i, start[i]);
+    }));
+
+    size_t procedural = m_procedural.size();
+    m_procedural.push_back(epsy);
+
+    // flat index of the points to set, each of which gets the next landscape in the arena
+    std::vector<size_t> points = this->find([&](size_t i) { return I.data()[i] == 1ul; });
+
+    size_t n = points.size();
+    size_t landscape = m_epsy_offset.size();
+    size_t offset = m_epsy.size();
+    m_epsy.resize(offset + n * epsy.window);
+    m_epsy_offset.resize(landscape + n);
+    m_epsy_size.resize(landscape + n, epsy.window);
+    m_epsy_procedural.resize(landscape + n, procedural);
+    m_epsy_shared.resize(landscape + n, 0);
+
+    #pragma omp parallel for
+    for (size_t k = 0; k < n; ++k) {
+        size_t i = points[k];
+        m_type.data()[i] = type;
+        m_K.data()[i] = K;
+        m_G.data()[i] = G;
+        m_index.data()[i] = landscape + k;
+        m_epsy_offset[landscape + k] = offset + k * epsy.window;
+
+        // window with a quarter of it left of the initial well
+        // (moved back from the initial well, of which the yield strain is known)
+        size_t j = start ? start[i] : 0;
+        size_t shift = j > epsy.window / 4 ? j - epsy.window / 4 : 0;
+        m_shift.data()[i] = start_epsy ? j : 0;
+        m_epsy0.data()[i] = start_epsy ? start_epsy[i] : -0.5 * epsy.increment(i, 0);
+        m_i.data()[i] = j - shift;
+        this->setWindow(i, shift);
+
+        if (Eps) {
+            detail::to_storage(m_storage, &Eps[i * m_stride_tensor2], this->strainPtr(i));
+        }
+
+        this->setStrainPoint(i, this->strainPtr(i));
+    }
+
+    m_grouped = false;
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::setCusp(
+    const xt::xtensor<size_t, N>& I,
+    double K,
+    double G,
+    const Procedural& epsy)
+{
+    this->setProcedural(I, Type::Cusp, K, G, epsy);
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::setSmooth(
+    const xt::xtensor<size_t, N>& I,
+    double K,
+    double G,
+    const Procedural& epsy)
+{
+    this->setProcedural(I, Type::Smooth, K, G, epsy);
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::setCusp(
+    const xt::xtensor<size_t, N>& I,
+    double K,
+    double G,
+    const Procedural& epsy,
+    const xt::xtensor<size_t, N>& index,
+    const xt::xtensor<double, N>& epsy_l,
+    const xt::xtensor<double, N + 2>& Eps)
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(m_type, index.shape()));
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(m_type, epsy_l.shape()));
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(Eps, m_shape_tensor2));
+    this->setProcedural(I, Type::Cusp, K, G, epsy, index.data(), epsy_l.data(), Eps.data());
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::setSmooth(
+    const xt::xtensor<size_t, N>& I,
+    double K,
+    double G,
+    const Procedural& epsy,
+    const xt::xtensor<size_t, N>& index,
+    const xt::xtensor<double, N>& epsy_l,
+    const xt::xtensor<double, N + 2>& Eps)
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(m_type, index.shape()));
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(m_type, epsy_l.shape()));
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(Eps, m_shape_tensor2));
+    this->setProcedural(I, Type::Smooth, K, G, epsy, index.data(), epsy_l.data(), Eps.data());
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::setWindow(size_t i, size_t shift)
+{
+    size_t l = m_index.data()[i];
+    const Procedural& gen = m_procedural[m_epsy_procedural[l]];
+    S* y = &m_epsy[m_epsy_offset[l]];
+    size_t n = m_epsy_size[l];
+    size_t s = m_shift.data()[i];
+
+    // first yield strain: continue from that of the current window (kept in "double", also if
+    // the yield strains are stored in "float"), adding the increments when moving forward
+    // (the sum is evaluated in the same order as from the beginning of the landscape),
+    // subtracting them when moving back (equal up to round-off, exact again at "shift == 0")
+    double y0 = m_epsy0.data()[i];
+
+    for (size_t m = s; m < shift; ++m) {
+        y0 += gen.increment(i, m);
+    }
+
+    for (size_t m = s; m > shift; --m) {
+        y0 -= gen.increment(i, m - 1);
+    }
+
+    if (shift == 0) {
+        y0 = -0.5 * gen.increment(i, 0);
+    }
+
+    m_epsy0.data()[i] = y0;
+    y[0] = y0;
+
+    for (size_t k = 1; k < n; ++k) {
+        y0 += gen.increment(i, shift + k - 1);
+        y[k] = y0;
+    }
+
+    m_shift.data()[i] = shift;
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::updateYieldIndex(size_t i, double epsd)
+{
+    size_t l = m_index.data()[i];
+    const S* y = &m_epsy[m_epsy_offset[l]];
+    size_t n = m_epsy_size[l];
+    size_t j = detail::yield_index(y, n, m_i.data()[i], epsd);
+
+    // procedural landscape: move the window until it contains "epsd"
+    // (keeping a quarter of the window left of the current index)
+    if (m_epsy_procedural[l] != detail::npos) {
+        while (epsd > y[n - 1] || (epsd <= y[0] && m_shift.data()[i] > 0)) {
+            size_t s = m_shift.data()[i];
+            size_t shift = s + j > n / 4 ? s + j - n / 4 : 0;
+            this->setWindow(i, shift);
+            j = detail::yield_index(y, n, s + j - shift, epsd);
+        }
+    }
+
+    m_i.data()[i] = j;
+    m_epsy_l.data()[i] = y[j];
+    m_epsy_r.data()[i] = y[j + 1];
+}
+
+template <size_t N, class S>
+inline size_t Array<N, S>::extendYieldRight(size_t n, const Increment& increment)
+{
+    return this->extend(n, increment, Output());
+}
+
+template <size_t N, class S>
+inline size_t Array<N, S>::extend(
+    size_t n,
+    const Increment& increment,
+    const Output& out,
+    const std::vector<size_t>* candidates)
+{
+    auto offends = [&](size_t i) { return !(n < this->marginRight(i)); };
+    std::vector<size_t> points;
+
+    if (candidates) {
+        std::copy_if(
+            candidates->cbegin(), candidates->cend(), std::back_inserter(points), offends);
+    }
+    else {
+        points = this->find(offends);
+    }
+
+    if (points.size() == 0) {
+        return 0;
+    }
+
+    std::vector<bool> extended(m_size, false);
+
+    while (points.size() > 0) {
+
+        // the landscapes to extend, and all points using them (which keep sharing the landscape)
+        std::vector<size_t> lands(points.size());
+        std::vector<size_t> slot(m_epsy_offset.size(), detail::npos);
+
+        for (size_t p = 0; p < points.size(); ++p) {
+            extended[points[p]] = true;
+            lands[p] = m_index.data()[points[p]];
+        }
+
+        std::sort(lands.begin(), lands.end());
+        lands.erase(std::unique(lands.begin(), lands.end()), lands.end());
+
+        for (size_t k = 0; k < lands.size(); ++k) {
+            slot[lands[k]] = k;
+        }
+
+        // (a landscape that is not shared has only one point: no search is needed)
+        std::vector<size_t> users = points;
+
+        if (std::any_of(lands.cbegin(), lands.cend(), [&](size_t l) { return m_epsy_shared[l]; })) {
+            users = this->find([&](size_t i) {
+                size_t type = m_type.data()[i];
+                bool plastic = type == Type::Cusp || type == Type::Smooth;
+                return plastic && slot[m_index.data()[i]] != detail::npos;
+            });
+        }
+
+        // of each landscape: the range of wells in use, and the point that defines the increment
+        std::vector<size_t> lo(lands.size(), detail::npos);
+        std::vector<size_t> hi(lands.size(), 0);
+        std::vector<size_t> first(lands.size(), detail::npos);
+
+        for (size_t i : users) {
+            size_t k = slot[m_index.data()[i]];
+            size_t j = m_i.data()[i];
+            lo[k] = std::min(lo[k], j);
+            hi[k] = std::max(hi[k], j);
+            first[k] = std::min(first[k], i);
+        }
+
+        // keep "n" wells left of the left-most point and make room for "n" wells right of the
+        // right-most point: in place if the landscape is large enough, otherwise moved to a new
+        // slot at the end of the arena (the old slot is reclaimed below)
+        std::vector<size_t> shift(lands.size());
+        std::vector<size_t> valid(lands.size());
+        std::vector<size_t> from(lands.size());
+
+        for (size_t k = 0; k < lands.size(); ++k) {
+            size_t l = lands[k];
+            size_t size = m_epsy_size[l];
+            shift[k] = lo[k] > n ? lo[k] - n : 0;
+            valid[k] = size;
+            from[k] = m_epsy_offset[l];
+            size_t need = std::max(size, hi[k] - shift[k] + n + 4);
+
+            if (need > size) {
+                m_epsy_offset[l] = m_epsy.size();
+                m_epsy_size[l] = need;
+                m_epsy.resize(m_epsy.size() + need);
+            }
+        }
+
+        // shift and complete the yield strains
+        #pragma omp parallel for
+        for (size_t k = 0; k < lands.size(); ++k) {
+            size_t l = lands[k];
+            const S* src = &m_epsy[from[k]];
+            S* y = &m_epsy[m_epsy_offset[l]];
+            size_t size = m_epsy_size[l];
+            size_t d = shift[k];
+            size_t p = first[k];
+            size_t s = m_shift.data()[p];
+
+            if (y != src || d > 0) {
+                std::copy(src + d, src + valid[k], y);
+            }
+
+            for (size_t j = valid[k] - d; j < size; ++j) {
+                y[j] = y[j - 1] + increment(p, s + d + j - 1);
+            }
+        }
+
+        // update the state of all points using the extended landscapes
+        #pragma omp parallel for
+        for (size_t u = 0; u < users.size(); ++u) {
+            size_t i = users[u];
+            size_t d = shift[slot[m_index.data()[i]]];
+            m_shift.data()[i] += d;
+            m_i.data()[i] -= d;
+            this->setStrainPoint(i, this->strainPtr(i), out);
+        }
+
+        // only the extended points can still offend
+        std::vector<size_t> previous = std::move(points);
+        points.clear();
+        std::copy_if(previous.cbegin(), previous.cend(), std::back_inserter(points), offends);
+    }
+
+    // reclaim the slots left by moved landscapes once these outweigh the landscapes in use
+    size_t live = std::accumulate(m_epsy_size.cbegin(), m_epsy_size.cend(), size_t(0));
+
+    if (m_epsy.size() > 2 * live) {
+        std::vector<size_t> order(m_epsy_offset.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return m_epsy_offset[a] < m_epsy_offset[b];
+        });
+
+        size_t offset = 0;
+
+        for (size_t l : order) {
+            if (m_epsy_offset[l] > offset) {
+                auto begin = m_epsy.begin() + m_epsy_offset[l];
+                std::copy(begin, begin + m_epsy_size[l], m_epsy.begin() + offset);
+                m_epsy_offset[l] = offset;
+            }
+            offset += m_epsy_size[l];
+        }
+
+        m_epsy.resize(offset);
+    }
+
+    return std::count(extended.cbegin(), extended.cend(), true);
+}
+
+template <size_t N, class S>
+inline size_t Array<N, S>::extendYieldRight(size_t n, const Procedural& increment)
+{
+    return this->extendYieldRight(
+        n, [&increment](size_t p, size_t k) { return increment.increment(p, k); });
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::setYieldExtension(size_t n, const Increment& increment)
+{
+    m_extend_n = n;
+    m_extend = increment;
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::setYieldExtension(size_t n, const Procedural& increment)
+{
+    m_extend_n = n;
+    m_extend = [increment](size_t p, size_t k) { return increment.increment(p, k); };
+}
+
+template <size_t N, class S>
+inline size_t Array<N, S>::nextended() const
+{
+    return m_nextended;
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::output(size_t i, const Output& out) const
+{
+    size_t type = m_type.data()[i];
+    bool plastic = type == Type::Cusp || type == Type::Smooth;
+
+    if (out.sig && out.tensor) {
+        detail::from_storage(m_storage, this->stressPtr(i), &out.sig[i * 9]);
+    }
+    else if (out.sig && static_cast<const void*>(out.sig) != this->stressPtr(0)) {
+        const S* sig = this->stressPtr(i);
+        std::copy(sig, sig + m_stride_state, &out.sig[i * m_stride_state]);
+    }
+
+    if (out.energy) {
+        out.energy[i] = this->pointEnergy(i);
+    }
+
+    if (out.epsp) {
+        out.epsp[i] = plastic ? 0.5 * (m_epsy_l.data()[i] + m_epsy_r.data()[i]) : 0.0;
+    }
+
+    if (out.index) {
+        out.index[i] = plastic ? m_shift.data()[i] + m_i.data()[i] : 0;
+    }
+}
+
+template <size_t N, class S>
+template <class E>
+inline void Array<N, S>::setStrainPoint(size_t i, const E* Eps, const Output& out)
+{
+    S* eps = this->strainPtr(i);
+    S* sig = this->stressPtr(i);
+
+    if (static_cast<const void*>(eps) != Eps) {
+        std::copy(Eps, Eps + m_stride_state, eps);
+    }
+
+    std::array<double, 9> Eps_t;
+    std::array<double, 9> Sig_t;
+    std::array<double, 9> Epsd;
+    double epsm;
+    double epsd = detail::strain_decomposition(this->strainTensor(i, Eps_t), &Epsd[0], epsm);
+    double g = 0.0;
+    m_epsm.data()[i] = epsm;
+    m_epsd.data()[i] = epsd;
+
+    size_t type = m_type.data()[i];
+
+    if (type == Type::Cusp || type == Type::Smooth) {
+        this->updateYieldIndex(i, epsd);
+    }
+
+    switch (type) {
+    case Type::Elastic:
+        g = detail::g_elastic(m_G.data()[i]);
+        break;
+    case Type::Cusp:
+        g = detail::g_cusp(m_G.data()[i], epsd, m_epsy_l.data()[i], m_epsy_r.data()[i]);
+        break;
+    case Type::Smooth:
+        g = detail::g_smooth(m_G.data()[i], epsd, m_epsy_l.data()[i], m_epsy_r.data()[i]);
+        break;
+    }
+
+    detail::stress(m_K.data()[i], epsm, g, &Epsd[0], &Sig_t[0]);
+    detail::to_storage(m_storage, &Sig_t[0], sig);
+
+    this->output(i, out);
+}
+
+template <size_t N, class S>
+template <size_t type, class E>
+inline void
+Array<N, S>::setStrainBlock(const size_t* index, size_t n, const E* Eps, const Output& out)
+{
+    size_t begin = index[0];
+    bool contiguous = index[n - 1] - begin == n - 1;
+    std::array<S, detail::simd::block * 9> eps_g; // gathered strain (if not "contiguous")
+    std::array<S, detail::simd::block * 9> sig_g; // gathered stress ,,
+    S* eps = this->strainPtr(begin);
+    S* sig = this->stressPtr(begin);
+
+    if (contiguous && static_cast<const void*>(eps) != &Eps[begin * m_stride_state]) {
+        std::copy(&Eps[begin * m_stride_state], &Eps[(begin + n) * m_stride_state], eps);
+    }
+    else if (!contiguous) {
+        eps_g.fill(0.0);
+        for (size_t p = 0; p < n; ++p) {
+            const E* e = &Eps[index[p] * m_stride_state];
+            std::copy(e, e + m_stride_state, &eps_g[p * m_stride_state]);
+            if (static_cast<const void*>(this->strainPtr(index[p])) != e) {
+                std::copy(e, e + m_stride_state, this->strainPtr(index[p]));
+            }
+        }
+        eps = &eps_g[0];
+        sig = &sig_g[0];
+    }
+
+    detail::Block b;
+    detail::strain_decomposition(eps, n, b, m_storage);
+
+    for (size_t p = 0; p < n; ++p) {
+        size_t i = index[p];
+        b.K[p] = m_K.data()[i];
+        b.G[p] = m_G.data()[i];
+        m_epsm.data()[i] = b.epsm[p];
+        m_epsd.data()[i] = b.epsd[p];
+    }
+
+    if (type == Type::Elastic) {
+        detail::g_elastic(b);
+    }
+    else {
+        for (size_t p = 0; p < n; ++p) {
+            size_t i = index[p];
+            this->updateYieldIndex(i, b.epsd[p]);
+            b.epsy_l[p] = m_epsy_l.data()[i];
+            b.epsy_r[p] = m_epsy_r.data()[i];
+        }
+
+        if (type == Type::Cusp) {
+            detail::g_cusp(b);
+        }
+        else {
+            detail::g_smooth(b);
+        }
+    }
+
+    detail::stress(b, n, sig, m_storage);
+
+    if (!contiguous) {
+        for (size_t p = 0; p < n; ++p) {
+            const S* s = &sig_g[p * m_stride_state];
+            std::copy(s, s + m_stride_state, this->stressPtr(index[p]));
+        }
+    }
+
+    for (size_t p = 0; p < n; ++p) {
+        this->output(index[p], out);
+    }
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::setStrain(const xt::xtensor<double, N + 2>& arg)
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(arg, m_shape_tensor2));
+    std::vector<double> buffer;
+    this->update(this->toStorage(arg.data(), Storage::Tensor, buffer), Output());
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::setStrain(
+    const xt::xtensor<double, N + 2>& arg,
+    xt::xtensor<double, N + 2>& sig,
+    xt::xtensor<double, N>& energy)
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(arg, m_shape_tensor2));
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(sig, m_shape_tensor2));
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(energy, m_shape));
+
+    // the stress is converted to "[3, 3]" tensors in the same pass (if needed)
+    std::vector<double> buffer;
+    Output out;
+    out.sig = sig.data();
+    out.energy = energy.data();
+    out.tensor = m_storage != Storage::Tensor;
+    this->update(this->toStorage(arg.data(), Storage::Tensor, buffer), out);
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::setStrainPtr(
+    const double* Eps,
+    double* Sig,
+    double* energy,
+    double* epsp,
+    size_t* index)
+{
+    Output out;
+    out.sig = Sig;
+    out.energy = energy;
+    out.epsp = epsp;
+    out.index = index;
+    this->update(Eps, out);
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::bindStorage(S* Eps, S* Sig)
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(Eps != nullptr && Sig != nullptr && Eps != Sig);
+
+    size_t n = m_size * m_stride_state;
+    const S* eps = this->strainPtr(0);
+    const S* sig = this->stressPtr(0);
+
+    if (eps != Eps) {
+        std::copy(eps, eps + n, Eps);
+    }
+
+    if (sig != Sig) {
+        std::copy(sig, sig + n, Sig);
+    }
+
+    m_eps_bound = Eps;
+    m_sig_bound = Sig;
+    std::vector<S>().swap(m_Eps);
+    std::vector<S>().swap(m_Sig);
+}
+
+template <size_t N, class S>
+inline void
+Array<N, S>::bindStorage(xt::xtensor<S, N + 2>& Eps, xt::xtensor<S, N + 2>& Sig)
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(m_storage == Storage::Tensor);
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(Eps, m_shape_tensor2));
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(Sig, m_shape_tensor2));
+    this->bindStorage(Eps.data(), Sig.data());
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::unbindStorage()
+{
+    if (!m_eps_bound) {
+        return;
+    }
+
+    size_t n = m_size * m_stride_state;
+    m_Eps.assign(m_eps_bound, m_eps_bound + n);
+    m_Sig.assign(m_sig_bound, m_sig_bound + n);
+    m_eps_bound = nullptr;
+    m_sig_bound = nullptr;
+}
+
+template <size_t N, class S>
+inline bool Array<N, S>::isBound() const
+{
+    return m_eps_bound != nullptr;
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::setStrain()
+{
+    this->update(this->strainPtr(0), Output());
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::setStorage(size_t storage)
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(!this->isBound());
+
+    if (storage == m_storage) {
+        return;
+    }
+
+    std::vector<double> Eps(m_size * m_stride_tensor2);
+    std::vector<double> Sig(m_size * m_stride_tensor2);
+    std::vector<double> buffer;
+    this->fromStorage(m_Eps.data(), Storage::Tensor, Eps.data());
+    this->fromStorage(m_Sig.data(), Storage::Tensor, Sig.data());
+
+    m_storage = storage;
+    m_stride_state = detail::storage_size(storage);
+
+    const double* eps = this->toStorage(Eps.data(), Storage::Tensor, buffer);
+    m_Eps.assign(eps, eps + m_size * m_stride_state);
+    const double* sig = this->toStorage(Sig.data(), Storage::Tensor, buffer);
+    m_Sig.assign(sig, sig + m_size * m_stride_state);
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::setStorageMandel(bool mandel)
+{
+    this->setStorage(mandel ? Storage::Mandel : Storage::Tensor);
+}
+
+template <size_t N, class S>
+inline bool Array<N, S>::isStorageMandel() const
+{
+    return m_storage == Storage::Mandel;
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::setStrainMandel(const xt::xtensor<double, N + 1>& arg)
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(arg, m_shape_mandel));
+    std::vector<double> buffer;
+    this->update(this->toStorage(arg.data(), Storage::Mandel, buffer), Output());
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::strainMandel(xt::xtensor<double, N + 1>& ret) const
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape_mandel));
+    this->fromStorage(this->strainPtr(0), Storage::Mandel, ret.data());
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::stressMandel(xt::xtensor<double, N + 1>& ret) const
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape_mandel));
+    this->fromStorage(this->stressPtr(0), Storage::Mandel, ret.data());
+}
+
+template <size_t N, class S>
+inline xt::xtensor<double, N + 1> Array<N, S>::StrainMandel() const
+{
+    xt::xtensor<double, N + 1> ret = xt::empty<double>(m_shape_mandel);
+    this->strainMandel(ret);
+    return ret;
+}
+
+template <size_t N, class S>
+inline xt::xtensor<double, N + 1> Array<N, S>::StressMandel() const
+{
+    xt::xtensor<double, N + 1> ret = xt::empty<double>(m_shape_mandel);
+    this->stressMandel(ret);
+    return ret;
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::setStoragePlaneStrain(bool plane)
+{
+    this->setStorage(plane ? Storage::PlaneStrain : Storage::Tensor);
+}
+
+template <size_t N, class S>
+inline bool Array<N, S>::isStoragePlaneStrain() const
+{
+    return m_storage == Storage::PlaneStrain;
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::setStrainPlane(const xt::xtensor<double, N + 1>& arg)
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(arg, m_shape_plane));
+    std::vector<double> buffer;
+    this->update(this->toStorage(arg.data(), Storage::PlaneStrain, buffer), Output());
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::strainPlane(xt::xtensor<double, N + 1>& ret) const
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape_plane));
+    this->fromStorage(this->strainPtr(0), Storage::PlaneStrain, ret.data());
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::stressPlane(xt::xtensor<double, N + 1>& ret) const
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape_plane));
+    this->fromStorage(this->stressPtr(0), Storage::PlaneStrain, ret.data());
+}
+
+template <size_t N, class S>
+inline xt::xtensor<double, N + 1> Array<N, S>::StrainPlane() const
+{
+    xt::xtensor<double, N + 1> ret = xt::empty<double>(m_shape_plane);
+    this->strainPlane(ret);
+    return ret;
+}
+
+template <size_t N, class S>
+inline xt::xtensor<double, N + 1> Array<N, S>::StressPlane() const
+{
+    xt::xtensor<double, N + 1> ret = xt::empty<double>(m_shape_plane);
+    this->stressPlane(ret);
+    return ret;
+}
+
+template <size_t N, class S>
+template <class E>
+inline void Array<N, S>::update(const E* Eps, const Output& out)
+{
+    this->groupTypes();
+
+    // candidate events: "(i, index)", with "index" the yield index of flat point "i" before the
+    // update (also points that may be changed by the landscape extension below)
+    std::vector<std::pair<size_t, size_t>> events;
+
+    #pragma omp parallel
+    {
+        std::vector<std::pair<size_t, size_t>> local; // per-thread buffer
+        std::array<size_t, detail::simd::block> index;
+
+        // one loop per type, over blocks of points of that type (see "m_points"),
+        // such that all blocks in a loop have the same cost
+        for (size_t type = 0; type < m_points.size(); ++type) {
+
+            const std::vector<size_t>& points = m_points[type];
+            size_t nblock = (points.size() + detail::simd::block - 1) / detail::simd::block;
+
+            #pragma omp for nowait
+            for (size_t iblock = 0; iblock < nblock; ++iblock) {
+
+                size_t begin = iblock * detail::simd::block;
+                size_t n = std::min(detail::simd::block, points.size() - begin);
+                const size_t* block = &points[begin];
+
+                if (m_record) {
+                    for (size_t p = 0; p < n; ++p) {
+                        index[p] = m_shift.data()[block[p]] + m_i.data()[block[p]];
+                    }
+                }
+
+                switch (type) {
+                case Type::Unset:
+                    for (size_t p = 0; p < n; ++p) {
+                        this->output(block[p], out);
+                    }
+                    break;
+                case Type::Elastic:
+                    this->template setStrainBlock<Type::Elastic>(block, n, Eps, out);
+                    break;
+                case Type::Cusp:
+                    this->template setStrainBlock<Type::Cusp>(block, n, Eps, out);
+                    break;
+                case Type::Smooth:
+                    this->template setStrainBlock<Type::Smooth>(block, n, Eps, out);
+                    break;
+                }
+
+                if (m_record) {
+                    for (size_t p = 0; p < n; ++p) {
+                        size_t i = block[p];
+                        bool extend = m_extend && !(m_extend_n < this->marginRight(i));
+                        if (m_shift.data()[i] + m_i.data()[i] != index[p] || extend) {
+                            local.emplace_back(i, index[p]);
+                        }
+                    }
+                }
+            }
+        }
+
+        if (m_record) {
+            #pragma omp critical
+            events.insert(events.end(), local.cbegin(), local.cend());
+        }
+    }
+
+    if (m_extend) {
+        m_nextended = this->extend(m_extend_n, m_extend, out);
+    }
+
+    if (m_record) {
+        this->storeEvents(events);
+    }
+}
+
+template <size_t N, class S>
+inline void
+Array<N, S>::updateAt(const size_t* index, size_t n, const double* Eps, size_t format)
+{
+    std::vector<std::pair<size_t, size_t>> events; // see "update"
+    std::vector<size_t> offenders; // candidates for the landscape extension
+    size_t stride = detail::storage_size(format);
+
+    #pragma omp parallel
+    {
+        std::vector<std::pair<size_t, size_t>> local; // per-thread buffers
+        std::vector<size_t> local_offenders;
+
+        #pragma omp for
+        for (size_t p = 0; p < n; ++p) {
+
+            size_t i = index[p];
+            GMATELASTOPLASTICQPOT3D_ASSERT(i < m_size);
+
+            if (m_type.data()[i] == Type::Unset) {
+                continue;
+            }
+
+            const double* eps = &Eps[i * stride];
+            std::array<double, 9> A;
+            std::array<double, 9> B;
+
+            if (format != m_storage) {
+                detail::from_storage(format, eps, &A[0]);
+                detail::to_storage(m_storage, &A[0], &B[0]);
+                eps = &B[0];
+            }
+
+            size_t j = m_shift.data()[i] + m_i.data()[i];
+            this->setStrainPoint(i, eps);
+            bool offends = m_extend && !(m_extend_n < this->marginRight(i));
+
+            if (offends) {
+                local_offenders.push_back(i);
+            }
+
+            if (m_record && (m_shift.data()[i] + m_i.data()[i] != j || offends)) {
+                local.emplace_back(i, j);
+            }
+        }
+
+        #pragma omp critical
+        {
+            events.insert(events.end(), local.cbegin(), local.cend());
+            offenders.insert(offenders.end(), local_offenders.cbegin(), local_offenders.cend());
+        }
+    }
+
+    m_nextended = 0;
+
+    if (offenders.size() > 0) {
+        std::sort(offenders.begin(), offenders.end());
+        m_nextended = this->extend(m_extend_n, m_extend, Output(), &offenders);
+    }
+
+    if (m_record) {
+        this->storeEvents(events);
+    }
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::storeEvents(std::vector<std::pair<size_t, size_t>>& events)
+{
+    std::sort(events.begin(), events.end());
+    m_event_point.clear();
+    m_event_jump.clear();
+
+    for (auto& e : events) {
+        size_t i = e.first;
+        auto jump = static_cast<ptrdiff_t>(m_shift.data()[i] + m_i.data()[i]) -
+                    static_cast<ptrdiff_t>(e.second);
+        if (jump != 0) {
+            m_event_point.push_back(i);
+            m_event_jump.push_back(jump);
+        }
+    }
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::setStrainAt(
+    const xt::xtensor<size_t, 1>& index,
+    const xt::xtensor<double, N + 2>& arg)
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(arg, m_shape_tensor2));
+    this->updateAt(index.data(), index.size(), arg.data(), Storage::Tensor);
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::setStrainWhere(
+    const xt::xtensor<size_t, N>& I,
+    const xt::xtensor<double, N + 2>& arg)
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(I, m_shape));
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(arg, m_shape_tensor2));
+    std::vector<size_t> index = this->find([&](size_t i) { return I.data()[i] == 1ul; });
+    this->updateAt(index.data(), index.size(), arg.data(), Storage::Tensor);
+}
+
+template <size_t N, class S>
+inline void
+Array<N, S>::stressAt(const xt::xtensor<size_t, 1>& index, xt::xtensor<double, 3>& ret) const
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, {index.size(), 3ul, 3ul}));
+
+    #pragma omp parallel for
+    for (size_t p = 0; p < index.size(); ++p) {
+        size_t i = index(p);
+        GMATELASTOPLASTICQPOT3D_ASSERT(i < m_size);
+        detail::from_storage(m_storage, this->stressPtr(i), &ret.data()[p * m_stride_tensor2]);
+    }
+}
+
+template <size_t N, class S>
+inline void
+Array<N, S>::energyAt(const xt::xtensor<size_t, 1>& index, xt::xtensor<double, 1>& ret) const
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, {index.size()}));
+
+    #pragma omp parallel for
+    for (size_t p = 0; p < index.size(); ++p) {
+        GMATELASTOPLASTICQPOT3D_ASSERT(index(p) < m_size);
+        ret(p) = this->pointEnergy(index(p));
+    }
+}
+
+template <size_t N, class S>
+inline xt::xtensor<double, 3> Array<N, S>::StressAt(const xt::xtensor<size_t, 1>& index) const
+{
+    std::array<size_t, 3> shape = {index.size(), 3, 3};
+    xt::xtensor<double, 3> ret = xt::empty<double>(shape);
+    this->stressAt(index, ret);
+    return ret;
+}
+
+template <size_t N, class S>
+inline xt::xtensor<double, 1> Array<N, S>::EnergyAt(const xt::xtensor<size_t, 1>& index) const
+{
+    std::array<size_t, 1> shape = {index.size()};
+    xt::xtensor<double, 1> ret = xt::empty<double>(shape);
+    this->energyAt(index, ret);
+    return ret;
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::distanceToYield(
+    const xt::xtensor<double, N + 2>& dEps,
+    xt::xtensor<double, N>& ret) const
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(dEps, m_shape_tensor2));
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape));
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < m_size; ++i) {
+        size_t type = m_type.data()[i];
+        std::array<double, 9> Eps;
+        if (type == Type::Cusp || type == Type::Smooth) {
+            ret.data()[i] = detail::distance_to_yield(
+                this->strainTensor(i, Eps),
+                &dEps.data()[i * m_stride_tensor2],
+                m_epsy_l.data()[i],
+                m_epsy_r.data()[i]);
+        }
+        else {
+            ret.data()[i] = std::numeric_limits<double>::infinity();
+        }
+    }
+}
+
+template <size_t N, class S>
+inline xt::xtensor<double, N>
+Array<N, S>::DistanceToYield(const xt::xtensor<double, N + 2>& dEps) const
+{
+    xt::xtensor<double, N> ret = xt::empty<double>(m_shape);
+    this->distanceToYield(dEps, ret);
+    return ret;
+}
+
+template <size_t N, class S>
+inline std::pair<double, size_t>
+Array<N, S>::minDistanceToYield(const xt::xtensor<double, N + 2>& dEps) const
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(dEps, m_shape_tensor2));
+
+    std::pair<double, size_t> ret(std::numeric_limits<double>::infinity(), 0);
+
+    #pragma omp parallel
+    {
+        std::pair<double, size_t> local(std::numeric_limits<double>::infinity(), 0);
+
+        #pragma omp for nowait
+        for (size_t i = 0; i < m_size; ++i) {
+            size_t type = m_type.data()[i];
+            std::array<double, 9> Eps;
+            if (type == Type::Cusp || type == Type::Smooth) {
+                double t = detail::distance_to_yield(
+                    this->strainTensor(i, Eps),
+                    &dEps.data()[i * m_stride_tensor2],
+                    m_epsy_l.data()[i],
+                    m_epsy_r.data()[i]);
+                if (t < local.first) {
+                    local = std::make_pair(t, i);
+                }
+            }
+        }
+
+        #pragma omp critical
+        if (local < ret) {
+            ret = local;
+        }
+    }
+
+    return ret;
+}
+
+template <size_t N, class S>
+inline std::vector<std::pair<char*, size_t>> Array<N, S>::checkpoint() const
+{
+    std::vector<std::pair<char*, size_t>> ret;
+
+    auto add = [&](const auto* data, size_t n) {
+        char* ptr = const_cast<char*>(reinterpret_cast<const char*>(data));
+        ret.emplace_back(ptr, n * sizeof(*data));
+    };
+
+    add(m_type.data(), m_size);
+    add(m_K.data(), m_size);
+    add(m_G.data(), m_size);
+    add(m_index.data(), m_size);
+    add(m_shift.data(), m_size);
+    add(m_epsy0.data(), m_size);
+    add(m_epsy.data(), m_epsy.size());
+    add(m_epsy_offset.data(), m_epsy_offset.size());
+    add(m_epsy_size.data(), m_epsy_size.size());
+    add(m_epsy_procedural.data(), m_epsy_procedural.size());
+    add(m_epsy_shared.data(), m_epsy_shared.size());
+    add(this->strainPtr(0), m_size * m_stride_state);
+    add(this->stressPtr(0), m_size * m_stride_state);
+    add(m_epsm.data(), m_size);
+    add(m_epsd.data(), m_size);
+    add(m_i.data(), m_size);
+    add(m_epsy_l.data(), m_size);
+    add(m_epsy_r.data(), m_size);
+
+    return ret;
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::save(const std::string& filename) const
+{
+    // header: identifier, version, byte order, layout, shape, storage format,
+    // number of landscape entries
+    std::vector<uint64_t> header = {detail::checkpoint_version, detail::checkpoint_order, N};
+    header.push_back(sizeof(S));
+    header.insert(header.end(), m_shape.cbegin(), m_shape.cend());
+    header.push_back(m_storage);
+    header.push_back(m_epsy.size());
+    header.push_back(m_epsy_offset.size());
+    header.push_back(m_procedural.size());
+
+    // parameters of the procedural landscapes, field by field
+    std::vector<uint64_t> procedural;
+
+    for (auto& p : m_procedural) {
+        procedural.push_back(p.distribution);
+        procedural.push_back(detail::bits(p.a));
+        procedural.push_back(detail::bits(p.b));
+        procedural.push_back(detail::bits(p.offset));
+        procedural.push_back(p.seed);
+        procedural.push_back(p.window);
+    }
+
+    {
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        file.write("GMATQPOT", 8);
+        file.write(reinterpret_cast<const char*>(header.data()), header.size() * 8);
+        file.write(reinterpret_cast<const char*>(procedural.data()), procedural.size() * 8);
+
+        if (!file) {
+            throw std::runtime_error("save: cannot write '" + filename + "'");
+        }
+    }
+
+    size_t offset = 8 + header.size() * 8 + procedural.size() * 8;
+
+    if (!detail::parallel_io(filename, this->checkpoint(), offset, true)) {
+        throw std::runtime_error("save: cannot write '" + filename + "'");
+    }
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::load(const std::string& filename)
+{
+    std::vector<uint64_t> header(4 + N + 4);
+    std::vector<uint64_t> procedural;
+    size_t nbytes;
+
+    auto corrupt = [&]() { return std::runtime_error("load: '" + filename + "' is corrupt"); };
+
+    {
+        std::ifstream file(filename, std::ios::binary | std::ios::ate);
+        nbytes = file ? static_cast<size_t>(file.tellg()) : 0;
+        file.seekg(0);
+        char magic[8];
+        file.read(magic, 8);
+        file.read(reinterpret_cast<char*>(header.data()), header.size() * 8);
+
+        if (!file || std::memcmp(magic, "GMATQPOT", 8) != 0) {
+            throw std::runtime_error("load: '" + filename + "' is not a checkpoint");
+        }
+
+        if (header[0] != detail::checkpoint_version) {
+            throw std::runtime_error("load: '" + filename + "' is of another version");
+        }
+
+        if (header[1] != detail::checkpoint_order) {
+            throw std::runtime_error("load: '" + filename + "' is of another byte order");
+        }
+
+        if (header[2] != N || header[3] != sizeof(S)) {
+            throw std::runtime_error("load: '" + filename + "' is of another type of Array");
+        }
+
+        // bounds on the sizes, before anything is allocated: all entries are at least 4 bytes
+        size_t size = 1;
+
+        for (size_t d = 0; d < N; ++d) {
+            if (header[4 + d] > 0 && size > nbytes / header[4 + d]) {
+                throw corrupt();
+            }
+            size *= header[4 + d];
+        }
+
+        if (header[4 + N] > Storage::PlaneStrain || size > nbytes / 4 ||
+            header[5 + N] > nbytes / 4 || header[6 + N] > nbytes / 4 ||
+            header[7 + N] > nbytes / 48) {
+            throw corrupt();
+        }
+
+        procedural.resize(6 * header[7 + N]);
+        file.read(reinterpret_cast<char*>(procedural.data()), procedural.size() * 8);
+
+        if (!file) {
+            throw corrupt();
+        }
+    }
+
+    // read to a new array, that replaces this one only if the file is valid
+    std::array<size_t, N> shape;
+    std::copy(&header[4], &header[4] + N, shape.begin());
+    Array<N, S> ret(shape);
+
+    ret.m_storage = header[4 + N];
+    ret.m_stride_state = detail::storage_size(ret.m_storage);
+    ret.m_Eps.resize(ret.m_size * ret.m_stride_state);
+    ret.m_Sig.resize(ret.m_size * ret.m_stride_state);
+    ret.m_epsy.resize(header[5 + N]);
+    ret.m_epsy_offset.resize(header[6 + N]);
+    ret.m_epsy_size.resize(header[6 + N]);
+    ret.m_epsy_procedural.resize(header[6 + N]);
+    ret.m_epsy_shared.resize(header[6 + N]);
+    ret.m_procedural.resize(header[7 + N]);
+
+    for (size_t p = 0; p < ret.m_procedural.size(); ++p) {
+        const uint64_t* q = &procedural[6 * p];
+        Procedural& epsy = ret.m_procedural[p];
+
+        if (q[0] > Procedural::Delta || q[5] < 4) {
+            throw corrupt();
+        }
+
+        epsy.distribution = static_cast<Procedural::Distribution>(q[0]);
+        epsy.a = detail::from_bits(q[1]);
+        epsy.b = detail::from_bits(q[2]);
+        epsy.offset = detail::from_bits(q[3]);
+        epsy.seed = q[4];
+        epsy.window = q[5];
+    }
+
+    auto blocks = ret.checkpoint();
+    size_t offset = 8 + header.size() * 8 + procedural.size() * 8;
+    size_t expected = offset;
+
+    for (auto& block : blocks) {
+        expected += block.second;
+    }
+
+    if (expected != nbytes) {
+        throw corrupt();
+    }
+
+    if (!detail::parallel_io(filename, blocks, offset, false)) {
+        throw std::runtime_error("load: cannot read '" + filename + "'");
+    }
+
+    // landscapes within the arena, points of a valid type, within their landscape
+    size_t nepsy = ret.m_epsy.size();
+    size_t nlandscape = ret.m_epsy_offset.size();
+    size_t nprocedural = ret.m_procedural.size();
+    bool valid = true;
+
+    #pragma omp parallel for reduction(&& : valid)
+    for (size_t l = 0; l < nlandscape; ++l) {
+        size_t n = ret.m_epsy_size[l];
+        size_t p = ret.m_epsy_procedural[l];
+        valid = valid && n >= 2 && n <= nepsy && ret.m_epsy_offset[l] <= nepsy - n &&
+                (p == detail::npos || p < nprocedural);
+    }
+
+    valid = valid && ret.allOf([&](size_t i) {
+        size_t type = ret.m_type.data()[i];
+        if (type == Type::Unset || type == Type::Elastic) {
+            return true;
+        }
+        size_t l = ret.m_index.data()[i];
+        return type <= Type::Smooth && l < nlandscape &&
+               ret.m_i.data()[i] < ret.m_epsy_size[l] - 1;
+    });
+
+    if (!valid) {
+        throw corrupt();
+    }
+
+    // keep the settings
+    ret.m_extend = m_extend;
+    ret.m_extend_n = m_extend_n;
+    ret.m_record = m_record;
+    *this = std::move(ret);
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::setRecordEvents(bool record)
+{
+    m_record = record;
+    m_event_point.clear();
+    m_event_jump.clear();
+}
+
+template <size_t N, class S>
+inline xt::xtensor<size_t, 1> Array<N, S>::EventPoints() const
+{
+    std::array<size_t, 1> shape = {m_event_point.size()};
+    xt::xtensor<size_t, 1> ret = xt::empty<size_t>(shape);
+    std::copy(m_event_point.cbegin(), m_event_point.cend(), ret.begin());
+    return ret;
+}
+
+template <size_t N, class S>
+inline xt::xtensor<ptrdiff_t, 1> Array<N, S>::EventJumps() const
+{
+    std::array<size_t, 1> shape = {m_event_jump.size()};
+    xt::xtensor<ptrdiff_t, 1> ret = xt::empty<ptrdiff_t>(shape);
+    std::copy(m_event_jump.cbegin(), m_event_jump.cend(), ret.begin());
+    return ret;
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::strain(xt::xtensor<double, N + 2>& ret) const
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape_tensor2));
+    this->fromStorage(this->strainPtr(0), Storage::Tensor, ret.data());
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::stress(xt::xtensor<double, N + 2>& ret) const
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape_tensor2));
+    this->fromStorage(this->stressPtr(0), Storage::Tensor, ret.data());
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::tangent(xt::xtensor<double, N + 4>& ret) const
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape_tensor4));
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < m_size; ++i) {
+        if (m_type.data()[i] == Type::Unset) {
+            GMatTensor::Cartesian3d::pointer::O4(&ret.data()[i * m_stride_tensor4]);
+        }
+        else {
+            detail::tangent(m_K.data()[i], m_G.data()[i], &ret.data()[i * m_stride_tensor4]);
+        }
+    }
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::tangentIsotropic(xt::xtensor<double, N + 1>& ret) const
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape_isotropic));
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < m_size; ++i) {
+        ret.data()[i * 2] = m_K.data()[i];
+        ret.data()[i * 2 + 1] = m_G.data()[i];
+    }
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::tangentDdot(
+    const xt::xtensor<double, N + 2>& arg,
+    xt::xtensor<double, N + 2>& ret) const
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(arg, m_shape_tensor2));
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape_tensor2));
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < m_size; ++i) {
+        detail::tangent_ddot(
+            m_K.data()[i],
+            m_G.data()[i],
+            &arg.data()[i * m_stride_tensor2],
+            &ret.data()[i * m_stride_tensor2]);
+    }
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::tangentVoigt(xt::xtensor<double, N + 2>& ret) const
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape_matrix6));
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < m_size; ++i) {
+        detail::tangent_voigt(m_K.data()[i], m_G.data()[i], &ret.data()[i * 36]);
+    }
+}
+
+template <size_t N, class S>
+inline void Array<N, S>::tangentMandel(xt::xtensor<double, N + 2>& ret) const
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(ret, m_shape_matrix6));
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < m_size; ++i) {
+        detail::tangent_mandel(m_K.data()[i], m_G.data()[i], &ret.data()[i * 36]);
+    }
+}
+
+template <size_t N, class S>
+inline xt::xtensor<double, N + 2> Array<N, S>::Strain() const
 {
     xt::xtensor<double, N + 2> ret = xt::empty<double>(m_shape_tensor2);
     this->strain(ret);
     return ret;
 }
 
-template <size_t N>
-inline xt::xtensor<double, N + 2> Array<N>::Stress() const
+template <size_t N, class S>
+inline xt::xtensor<double, N + 2> Array<N, S>::Stress() const
 {
     xt::xtensor<double, N + 2> ret = xt::empty<double>(m_shape_tensor2);
     this->stress(ret);
     return ret;
 }
 
-template <size_t N>
-inline xt::xtensor<double, N + 4> Array<N>::Tangent() const
+template <size_t N, class S>
+inline xt::xtensor<double, N + 4> Array<N, S>::Tangent() const
 {
     xt::xtensor<double, N + 4> ret = xt::empty<double>(m_shape_tensor4);
     this->tangent(ret);
     return ret;
 }
 
-template <size_t N>
-inline xt::xtensor<size_t, N> Array<N>::CurrentIndex() const
+template <size_t N, class S>
+inline xt::xtensor<size_t, N> Array<N, S>::CurrentIndex() const
 {
     xt::xtensor<size_t, N> ret = xt::empty<size_t>(m_shape);
     this->currentIndex(ret);
     return ret;
 }
 
-template <size_t N>
-inline xt::xtensor<double, N> Array<N>::CurrentYieldLeft() const
+template <size_t N, class S>
+inline xt::xtensor<double, N> Array<N, S>::CurrentYieldLeft() const
 {
     xt::xtensor<double, N> ret = xt::empty<double>(m_shape);
     this->currentYieldLeft(ret);
     return ret;
 }
 
-template <size_t N>
-inline xt::xtensor<double, N> Array<N>::CurrentYieldRight() const
+template <size_t N, class S>
+inline xt::xtensor<double, N> Array<N, S>::CurrentYieldRight() const
 {
     xt::xtensor<double, N> ret = xt::empty<double>(m_shape);
     this->currentYieldRight(ret);
     return ret;
 }
 
-template <size_t N>
-inline xt::xtensor<double, N> Array<N>::Epsp() const
+template <size_t N, class S>
+inline xt::xtensor<double, N> Array<N, S>::Epsp() const
 {
     xt::xtensor<double, N> ret = xt::empty<double>(m_shape);
     this->epsp(ret);
     return ret;
 }
 
-template <size_t N>
-inline xt::xtensor<double, N> Array<N>::Energy() const
+template <size_t N, class S>
+inline xt::xtensor<double, N> Array<N, S>::Energy() const
 {
     xt::xtensor<double, N> ret = xt::empty<double>(m_shape);
     this->energy(ret);
     return ret;
 }
 
-template <size_t N>
-inline auto Array<N>::getElastic(const std::array<size_t, N>& index) const
+template <size_t N, class S>
+inline xt::xtensor<double, N> Array<N, S>::Epsd() const
 {
-    GMATELASTOPLASTICQPOT3D_ASSERT(m_type[index] == Type::Elastic);
-    return m_Elastic[m_index[index]];
+    xt::xtensor<double, N> ret = xt::empty<double>(m_shape);
+    this->epsd(ret);
+    return ret;
 }
 
-template <size_t N>
-inline auto Array<N>::getCusp(const std::array<size_t, N>& index) const
+template <size_t N, class S>
+inline xt::xtensor<double, N> Array<N, S>::Sigd() const
 {
-    GMATELASTOPLASTICQPOT3D_ASSERT(m_type[index] == Type::Cusp);
-    return m_Cusp[m_index[index]];
+    xt::xtensor<double, N> ret = xt::empty<double>(m_shape);
+    this->sigd(ret);
+    return ret;
 }
 
-template <size_t N>
-inline auto Array<N>::getSmooth(const std::array<size_t, N>& index) const
+template <size_t N, class S>
+inline xt::xtensor<double, N + 1> Array<N, S>::TangentIsotropic() const
 {
-    GMATELASTOPLASTICQPOT3D_ASSERT(m_type[index] == Type::Smooth);
-    return m_Smooth[m_index[index]];
+    xt::xtensor<double, N + 1> ret = xt::empty<double>(m_shape_isotropic);
+    this->tangentIsotropic(ret);
+    return ret;
 }
 
-template <size_t N>
-inline auto* Array<N>::refElastic(const std::array<size_t, N>& index)
+template <size_t N, class S>
+inline xt::xtensor<double, N + 2>
+Array<N, S>::TangentDdot(const xt::xtensor<double, N + 2>& arg) const
+{
+    xt::xtensor<double, N + 2> ret = xt::empty<double>(m_shape_tensor2);
+    this->tangentDdot(arg, ret);
+    return ret;
+}
+
+template <size_t N, class S>
+inline xt::xtensor<double, N + 2> Array<N, S>::TangentVoigt() const
+{
+    xt::xtensor<double, N + 2> ret = xt::empty<double>(m_shape_matrix6);
+    this->tangentVoigt(ret);
+    return ret;
+}
+
+template <size_t N, class S>
+inline xt::xtensor<double, N + 2> Array<N, S>::TangentMandel() const
+{
+    xt::xtensor<double, N + 2> ret = xt::empty<double>(m_shape_matrix6);
+    this->tangentMandel(ret);
+    return ret;
+}
+
+template <size_t N, class S>
+inline auto Array<N, S>::getElastic(const std::array<size_t, N>& index) const
 {
     GMATELASTOPLASTICQPOT3D_ASSERT(m_type[index] == Type::Elastic);
-    return &m_Elastic[m_index[index]];
+    size_t i = this->flat(index);
+    Elastic ret(m_K.data()[i], m_G.data()[i]);
+    std::array<double, 9> Eps;
+    ret.setStrainPtr(this->strainTensor(i, Eps));
+    return ret;
 }
 
-template <size_t N>
-inline auto* Array<N>::refCusp(const std::array<size_t, N>& index)
+template <size_t N, class S>
+inline auto Array<N, S>::getCusp(const std::array<size_t, N>& index) const
 {
     GMATELASTOPLASTICQPOT3D_ASSERT(m_type[index] == Type::Cusp);
-    return &m_Cusp[m_index[index]];
+    size_t i = this->flat(index);
+    Cusp ret(m_K.data()[i], m_G.data()[i], this->landscape(m_index.data()[i]), false);
+    std::array<double, 9> Eps;
+    ret.setStrainPtr(this->strainTensor(i, Eps));
+    return ret;
 }
 
-template <size_t N>
-inline auto* Array<N>::refSmooth(const std::array<size_t, N>& index)
+template <size_t N, class S>
+inline auto Array<N, S>::getSmooth(const std::array<size_t, N>& index) const
 {
     GMATELASTOPLASTICQPOT3D_ASSERT(m_type[index] == Type::Smooth);
-    return &m_Smooth[m_index[index]];
+    size_t i = this->flat(index);
+    Smooth ret(m_K.data()[i], m_G.data()[i], this->landscape(m_index.data()[i]), false);
+    std::array<double, 9> Eps;
+    ret.setStrainPtr(this->strainTensor(i, Eps));
+    return ret;
 }
 
 } // namespace Cartesian3d
@@ -0,0 +1,286 @@
+/*
+
+(c - MIT) T.W.J. de Geus (Tom) | www.geus.me | github.com/tdegeus/GMatElastoPlasticQPot3d
+
+*/
+
+#ifndef GMATELASTOPLASTICQPOT3D_CARTESIAN3D_MAPPED_HPP
+#define GMATELASTOPLASTICQPOT3D_CARTESIAN3D_MAPPED_HPP
+
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Cartesian3d.h"
+
+namespace GMatElastoPlasticQPot3d {
+namespace Cartesian3d {
+
+namespace detail {
+
+// ".npy" dtype(s) matching "T" (little-endian)
+template <class T>
+inline bool npy_dtype(const std::string& descr);
+
+template <>
+inline bool npy_dtype<double>(const std::string& descr)
+{
+    return descr == "<f8";
+}
+
+template <>
+inline bool npy_dtype<float>(const std::string& descr)
+{
+    return descr == "<f4";
+}
+
+template <>
+inline bool npy_dtype<size_t>(const std::string& descr)
+{
+    static_assert(sizeof(size_t) == 8, "64-bit size_t assumed");
+    return descr == "<u8" || descr == "<i8";
+}
+
+// Check the values read as "T" from a ".npy" file with dtype "descr"
+template <class T>
+inline bool npy_valid(const std::string&, const T*, size_t)
+{
+    return true;
+}
+
+// "<i8" read as "size_t": no negative values
+template <>
+inline bool npy_valid<size_t>(const std::string& descr, const size_t* data, size_t n)
+{
+    if (descr != "<i8") {
+        return true;
+    }
+
+    bool ret = true;
+
+    #pragma omp parallel for reduction(&& : ret)
+    for (size_t i = 0; i < n; ++i) {
+        ret = ret && static_cast<int64_t>(data[i]) >= 0;
+    }
+
+    return ret;
+}
+
+// Value of "key" in the header dictionary of a ".npy" file, e.g. "{'descr': '<f8', ...}"
+inline std::string npy_value(const std::string& header, const std::string& key)
+{
+    size_t i = header.find("'" + key + "'");
+
+    if (i == std::string::npos) {
+        throw std::runtime_error("npy: '" + key + "' not found");
+    }
+
+    i = header.find(':', i) + 1;
+
+    while (header[i] == ' ') {
+        ++i;
+    }
+
+    size_t j = header[i] == '(' ? header.find(')', i) + 1 : header.find_first_of(",}", i);
+    return header.substr(i, j - i);
+}
+
+} // namespace detail
+
+template <class T>
+inline Mapped<T>::Mapped(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+
+    if (!file) {
+        throw std::runtime_error("npy: cannot open '" + filename + "'");
+    }
+
+    // magic string, version, header length (2 bytes for version 1, 4 bytes otherwise)
+    char magic[8];
+    file.read(magic, 8);
+
+    if (!file || std::memcmp(magic, "\x93NUMPY", 6) != 0) {
+        throw std::runtime_error("npy: '" + filename + "' is not a .npy file");
+    }
+
+    unsigned char len[4] = {0, 0, 0, 0};
+    size_t nlen = magic[6] == 1 ? 2 : 4;
+    file.read(reinterpret_cast<char*>(len), nlen);
+    size_t n = len[0] | (len[1] << 8) | (len[2] << 16) | (static_cast<size_t>(len[3]) << 24);
+
+    std::string header(n, ' ');
+    file.read(&header[0], n);
+
+    if (!file) {
+        throw std::runtime_error("npy: '" + filename + "' is truncated");
+    }
+
+    std::string descr = detail::npy_value(header, "descr").substr(1, 3);
+
+    if (!detail::npy_dtype<T>(descr)) {
+        throw std::runtime_error("npy: '" + filename + "' has an incompatible dtype");
+    }
+
+    if (detail::npy_value(header, "fortran_order") != "False") {
+        throw std::runtime_error("npy: '" + filename + "' is not C-contiguous");
+    }
+
+    // shape, e.g. "(3, 4)", "(3,)", or "()"
+    std::string shape = detail::npy_value(header, "shape");
+
+    for (size_t i = 1; i < shape.size();) {
+        size_t j = shape.find_first_of(",)", i);
+        if (j > i) {
+            m_shape.push_back(std::stoul(shape.substr(i, j - i)));
+        }
+        i = shape.find_first_not_of(", ", j);
+        if (i == std::string::npos || shape[i] == ')') {
+            break;
+        }
+    }
+
+    this->map(filename, 8 + nlen + n);
+
+    if (!detail::npy_valid(descr, m_data, m_size)) {
+        this->unmap();
+        throw std::runtime_error("npy: '" + filename + "' has negative indices");
+    }
+}
+
+template <class T>
+inline Mapped<T>::Mapped(
+    const std::string& filename,
+    const std::vector<size_t>& shape,
+    size_t offset)
+    : m_shape(shape)
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(offset % alignof(T) == 0);
+    this->map(filename, offset);
+}
+
+template <class T>
+inline Mapped<T>::Mapped(Mapped&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+template <class T>
+inline Mapped<T>& Mapped<T>::operator=(Mapped&& other) noexcept
+{
+    if (this != &other) {
+        this->unmap();
+        m_shape = std::move(other.m_shape);
+        m_size = other.m_size;
+        m_data = other.m_data;
+        m_map = other.m_map;
+        m_map_size = other.m_map_size;
+        m_read = std::move(other.m_read);
+        other.m_size = 0;
+        other.m_data = nullptr;
+        other.m_map = nullptr;
+        other.m_map_size = 0;
+    }
+    return *this;
+}
+
+template <class T>
+inline Mapped<T>::~Mapped()
+{
+    this->unmap();
+}
+
+template <class T>
+inline void Mapped<T>::map(const std::string& filename, size_t offset)
+{
+    m_size = 1;
+
+    for (auto& n : m_shape) {
+        m_size *= n;
+    }
+
+    size_t nbytes = offset + m_size * sizeof(T);
+
+#ifndef _WIN32
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    struct stat st;
+
+    if (fd < 0 || ::fstat(fd, &st) != 0) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        throw std::runtime_error("mmap: cannot open '" + filename + "'");
+    }
+
+    if (static_cast<size_t>(st.st_size) < nbytes) {
+        ::close(fd);
+        throw std::runtime_error("mmap: '" + filename + "' is smaller than its shape");
+    }
+
+    if (nbytes > 0) {
+        void* map = ::mmap(nullptr, nbytes, PROT_READ, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("mmap: cannot map '" + filename + "'");
+        }
+        m_map = map;
+        m_map_size = nbytes;
+        m_data = reinterpret_cast<const T*>(static_cast<const char*>(m_map) + offset);
+    }
+
+    ::close(fd);
+#else
+    std::ifstream file(filename, std::ios::binary);
+    m_read.resize(offset + m_size * sizeof(T) + alignof(T));
+    size_t shift = (alignof(T) - reinterpret_cast<uintptr_t>(m_read.data()) % alignof(T));
+    file.read(m_read.data() + shift % alignof(T), nbytes);
+
+    if (!file) {
+        throw std::runtime_error("mmap: cannot read '" + filename + "'");
+    }
+
+    m_data = reinterpret_cast<const T*>(m_read.data() + shift % alignof(T) + offset);
+#endif
+}
+
+template <class T>
+inline void Mapped<T>::unmap()
+{
+#ifndef _WIN32
+    if (m_map) {
+        ::munmap(m_map, m_map_size);
+    }
+#endif
+    m_map = nullptr;
+    m_map_size = 0;
+    m_data = nullptr;
+    m_read.clear();
+}
+
+template <class T>
+inline const std::vector<size_t>& Mapped<T>::shape() const
+{
+    return m_shape;
+}
+
+template <class T>
+inline size_t Mapped<T>::size() const
+{
+    return m_size;
+}
+
+template <class T>
+inline const T* Mapped<T>::data() const
+{
+    return m_data;
+}
+
+} // namespace Cartesian3d
+} // namespace GMatElastoPlasticQPot3d
+
+#endif
@@ -15,17 +15,24 @@ namespace Cartesian3d {
 inline Smooth::Smooth(double K, double G, const xt::xtensor<double, 1>& epsy, bool init_elastic)
     : m_K(K), m_G(G)
 {
-    xt::xtensor<double, 1> y = xt::sort(epsy);
-
-    if (init_elastic) {
-        if (y(0) != -y(1)) {
-            y = xt::concatenate(xt::xtuple(xt::xtensor<double, 1>({-y(0)}), y));
-        }
-    }
+    m_yield = QPot::Static(0.0, detail::yield_sequence(epsy, init_elastic));
+}
 
-    GMATELASTOPLASTICQPOT3D_ASSERT(y.size() > 1);
+inline Smooth::Smooth(
+    double K,
+    double G,
+    const xt::xtensor<double, 1>& epsy,
+    const xt::xtensor<double, 2>& Eps,
+    bool init_elastic)
+    : m_K(K), m_G(G)
+{
+    GMATELASTOPLASTICQPOT3D_ASSERT(xt::has_shape(Eps, {3, 3}));
 
-    m_yield = QPot::Static(0.0, y);
+    std::array<double, 9> Epsd;
+    double epsm;
+    double epsd = detail::strain_decomposition(Eps.data(), &Epsd[0], epsm);
+    m_yield = QPot::Static(epsd, detail::yield_sequence(epsy, init_elastic));
+    this->setStrain(Eps);
 }
 
 inline double Smooth::K() const
@@ -75,21 +82,20 @@ inline double Smooth::epsp() const
 
 inline double Smooth::energy() const
 {
-    namespace GT = GMatTensor::Cartesian3d::pointer;
-    std::array<double, 9> Epsd;
-    double epsm = GT::Hydrostatic_deviatoric(&m_Eps[0], &Epsd[0]);
-    double epsd = std::sqrt(0.5 * GT::A2s_ddot_B2s(&Epsd[0], &Epsd[0]));
-
-    double U = 3.0 * m_K * std::pow(epsm, 2.0);
-
-    double eps_min = 0.5 * (m_yield.currentYieldRight() + m_yield.currentYieldLeft());
-    double deps_y = 0.5 * (m_yield.currentYieldRight() - m_yield.currentYieldLeft());
+    return detail::energy_smooth(
+        m_K, m_G, m_epsm, m_epsd, m_yield.currentYieldLeft(), m_yield.currentYieldRight());
+}
 
-    double V
-        = -4.0 * m_G * std::pow(deps_y / M_PI, 2.0)
-        * (1.0 + cos(M_PI / deps_y * (epsd - eps_min)));
+inline double Smooth::epsd() const
+{
+    return m_epsd;
+}
 
-    return U + V;
+inline double Smooth::sigd() const
+{
+    double g =
+        detail::g_smooth(m_G, m_epsd, m_yield.currentYieldLeft(), m_yield.currentYieldRight());
+    return 2.0 * std::abs(g) * m_epsd;
 }
 
 inline bool Smooth::checkYieldBoundLeft(size_t n) const
@@ -105,34 +111,15 @@ inline bool Smooth::checkYieldBoundRight(size_t n) const
 template <class T>
 inline void Smooth::setStrainPtr(const T* arg)
 {
-    namespace GT = GMatTensor::Cartesian3d::pointer;
     std::copy(arg, arg + 9, m_Eps.begin());
 
     std::array<double, 9> Epsd;
-    double epsm = GT::Hydrostatic_deviatoric(&m_Eps[0], &Epsd[0]);
-    double epsd = std::sqrt(0.5 * GT::A2s_ddot_B2s(&Epsd[0], &Epsd[0]));
-    m_yield.setPosition(epsd);
-
-    m_Sig[0] = m_Sig[4] = m_Sig[8] = 3.0 * m_K * epsm;
-
-    if (epsd <= 0.0) {
-        m_Sig[1] = m_Sig[2] = m_Sig[3] = m_Sig[5] = m_Sig[6] = m_Sig[7] = 0.0;
-        return;
-    }
-
-    double eps_min = 0.5 * (m_yield.currentYieldRight() + m_yield.currentYieldLeft());
-    double deps_y = 0.5 * (m_yield.currentYieldRight() - m_yield.currentYieldLeft());
+    m_epsd = detail::strain_decomposition(&m_Eps[0], &Epsd[0], m_epsm);
+    m_yield.setPosition(m_epsd);
 
-    double g = (2.0 * m_G / epsd) * (deps_y / M_PI) * sin(M_PI / deps_y * (epsd - eps_min));
-    m_Sig[0] += g * Epsd[0];
-    m_Sig[1] = g * Epsd[1];
-    m_Sig[2] = g * Epsd[2];
-    m_Sig[3] = g * Epsd[3];
-    m_Sig[4] += g * Epsd[4];
-    m_Sig[5] = g * Epsd[5];
-    m_Sig[6] = g * Epsd[6];
-    m_Sig[7] = g * Epsd[7];
-    m_Sig[8] += g * Epsd[8];
+    double g =
+        detail::g_smooth(m_G, m_epsd, m_yield.currentYieldLeft(), m_yield.currentYieldRight());
+    detail::stress(m_K, m_epsm, g, &Epsd[0], &m_Sig[0]);
 }
 
 template <class T>
@@ -150,10 +137,7 @@ inline void Smooth::stressPtr(T* ret) const
 template <class T>
 inline void Smooth::tangentPtr(T* ret) const
 {
-    auto II = Cartesian3d::II();
-    auto I4d = Cartesian3d::I4d();
-    auto C = m_K * II + 2.0 * m_G * I4d;
-    std::copy(C.cbegin(), C.cend(), ret);
+    detail::tangent(m_K, m_G, ret);
 }
 
 template <class T>
@@ -37,92 +37,62 @@ auto construct_Array(T& self)
         .def("isSmooth", &S::isSmooth, "Boolean-matrix: true for Smooth.")
 
         .def(
-            "setElastic",
-            py::overload_cast<
-                const xt::xtensor<size_t, S::rank>&,
-                const xt::xtensor<size_t, S::rank>&,
-                const xt::xtensor<double, 1>&,
-                const xt::xtensor<double, 1>&>(&S::setElastic),
-            "Set specific entries 'Elastic'.",
-            py::arg("I"),
-            py::arg("idx"),
-            py::arg("K"),
-            py::arg("G"))
+            "setStrain",
+            py::overload_cast<const xt::xtensor<double, S::rank + 2>&>(&S::setStrain),
+            "Set strain tensors.",
+            py::arg("Eps"))
 
         .def(
-            "setCusp",
-            py::overload_cast<
-                const xt::xtensor<size_t, S::rank>&,
-                const xt::xtensor<size_t, S::rank>&,
-                const xt::xtensor<double, 1>&,
-                const xt::xtensor<double, 1>&,
-                const xt::xtensor<double, 2>&,
-                bool>(&S::setCusp),
-            "Set specific entries 'Cusp'.",
-            py::arg("I"),
-            py::arg("idx"),
-            py::arg("K"),
-            py::arg("G"),
-            py::arg("epsy"),
-            py::arg("init_elastic") = true)
+            "setStrainAt",
+            &S::setStrainAt,
+            "Set strain tensors of a subset of points (flat indices).",
+            py::arg("index"),
+            py::arg("Eps"))
 
         .def(
-            "setSmooth",
-            py::overload_cast<
-                const xt::xtensor<size_t, S::rank>&,
-                const xt::xtensor<size_t, S::rank>&,
-                const xt::xtensor<double, 1>&,
-                const xt::xtensor<double, 1>&,
-                const xt::xtensor<double, 2>&,
-                bool>(&S::setSmooth),
-            "Set specific entries 'Smooth'.",
+            "setStrainWhere",
+            &S::setStrainWhere,
+            "Set strain tensors of a subset of points ('I == 1').",
             py::arg("I"),
-            py::arg("idx"),
-            py::arg("K"),
-            py::arg("G"),
-            py::arg("epsy"),
-            py::arg("init_elastic") = true)
+            py::arg("Eps"))
 
         .def(
-            "setElastic",
-            py::overload_cast<const xt::xtensor<size_t, S::rank>&, double, double>(
-                &S::setElastic),
-            "Set specific entries 'Elastic'.",
-            py::arg("I"),
-            py::arg("K"),
-            py::arg("G"))
+            "setStorageMandel",
+            &S::setStorageMandel,
+            "Store strain and stress as 6 Mandel components.",
+            py::arg("mandel") = true)
+
+        .def("isStorageMandel", &S::isStorageMandel, "Strain and stress stored in Mandel form.")
 
         .def(
-            "setCusp",
-            py::overload_cast<
-                const xt::xtensor<size_t, S::rank>&,
-                double,
-                double,
-                const xt::xtensor<double, 1>&,
-                bool>(&S::setCusp),
-            "Set specific entries 'Cusp'.",
-            py::arg("I"),
-            py::arg("K"),
-            py::arg("G"),
-            py::arg("epsy"),
-            py::arg("init_elastic") = true)
+            "setStrainMandel",
+            &S::setStrainMandel,
+            "Set strain tensors in Mandel notation '[..., 6]'.",
+            py::arg("Eps"))
+
+        .def("StrainMandel", &S::StrainMandel, "Get strain tensors in Mandel notation.")
+        .def("StressMandel", &S::StressMandel, "Get stress tensors in Mandel notation.")
 
         .def(
-            "setSmooth",
-            py::overload_cast<
-                const xt::xtensor<size_t, S::rank>&,
-                double,
-                double,
-                const xt::xtensor<double, 1>&,
-                bool>(&S::setSmooth),
-            "Set specific entries 'Smooth'.",
-            py::arg("I"),
-            py::arg("K"),
-            py::arg("G"),
-            py::arg("epsy"),
-            py::arg("init_elastic") = true)
+            "setStoragePlaneStrain",
+            &S::setStoragePlaneStrain,
+            "Store strain and stress as '[xx, xy, yy, zz]' (plane strain).",
+            py::arg("plane") = true)
+
+        .def("isStoragePlaneStrain", &S::isStoragePlaneStrain, "Plane strain storage.")
+
+        .def(
+            "setStrainPlane",
+            &S::setStrainPlane,
+            "Set plane strain tensors '[..., 4]' ('[xx, xy, yy, zz]').",
+            py::arg("Eps"))
+
+        .def("StrainPlane", &S::StrainPlane, "Get strain tensors '[xx, xy, yy, zz]'.")
+        .def("StressPlane", &S::StressPlane, "Get stress tensors '[xx, xy, yy, zz]'.")
+
+        .def("StressAt", &S::StressAt, "Get stress tensors of subset of points.", py::arg("index"))
+        .def("EnergyAt", &S::EnergyAt, "Get energies of subset of points.", py::arg("index"))
 
-        .def("setStrain", &S::setStrain, "Set strain tensors.", py::arg("Eps"))
         .def("Strain", &S::Strain, "Get strain tensors.")
         .def("Stress", &S::Stress, "Get stress tensors.")
         .def("Tangent", &S::Tangent, "Get stiffness tensors.")
@@ -131,9 +101,66 @@ auto construct_Array(T& self)
         .def("CurrentYieldRight", &S::CurrentYieldRight, "Get right yield strains.")
         .def("Epsp", &S::Epsp, "Get equivalent plastic strains.")
         .def("Energy", &S::Energy, "Get energies.")
-        .def("getElastic", &S::getElastic, "Returns underlying Elastic model.")
-        .def("getCusp", &S::getCusp, "Returns underlying Cusp model.")
-        .def("getSmooth", &S::getSmooth, "Returns underlying Smooth model.")
+        .def("Epsd", &S::Epsd, "Get equivalent strains.")
+        .def("Sigd", &S::Sigd, "Get equivalent stresses.")
+        .def("TangentIsotropic", &S::TangentIsotropic, "Get (K, G) that define the tangent.")
+        .def("TangentDdot", &S::TangentDdot, "Get tangent : arg.", py::arg("arg"))
+        .def("TangentVoigt", &S::TangentVoigt, "Get stiffness in Voigt notation (6x6).")
+        .def("TangentMandel", &S::TangentMandel, "Get stiffness in Mandel notation (6x6).")
+
+        .def("yieldMarginLeft", &S::yieldMarginLeft, "Minimal number of wells to the far-left.")
+        .def("yieldMarginRight", &S::yieldMarginRight, "Minimal number of wells to the far-right.")
+
+        .def(
+            "OffendersYieldBoundLeft",
+            &S::OffendersYieldBoundLeft,
+            "Flat indices of the points less than 'n' wells from the far-left.",
+            py::arg("n") = 0)
+
+        .def(
+            "OffendersYieldBoundRight",
+            &S::OffendersYieldBoundRight,
+            "Flat indices of the points less than 'n' wells from the far-right.",
+            py::arg("n") = 0)
+
+        .def(
+            "extendYieldRight",
+            py::overload_cast<size_t, const GMatElastoPlasticQPot3d::Cartesian3d::Procedural&>(
+                &S::extendYieldRight),
+            "Extend landscapes of points less than 'n' wells from the far-right.",
+            py::arg("n"),
+            py::arg("increment"))
+
+        .def(
+            "setYieldExtension",
+            py::overload_cast<size_t, const GMatElastoPlasticQPot3d::Cartesian3d::Procedural&>(
+                &S::setYieldExtension),
+            "Extend landscapes automatically in 'setStrain'.",
+            py::arg("n"),
+            py::arg("increment"))
+
+        .def("nextended", &S::nextended, "Number of points extended by the last 'setStrain'.")
+
+        .def(
+            "DistanceToYield",
+            &S::DistanceToYield,
+            "Per point: strain step 't' along 'dEps' to the edge of the current well.",
+            py::arg("dEps"))
+
+        .def(
+            "minDistanceToYield",
+            &S::minDistanceToYield,
+            "Smallest strain step 't' along 'dEps' to a yield event, and its point (flat index).",
+            py::arg("dEps"))
+
+        .def(
+            "setRecordEvents",
+            &S::setRecordEvents,
+            "Record the points of which the potential index changes in 'setStrain'.",
+            py::arg("record") = true)
+
+        .def("EventPoints", &S::EventPoints, "Flat indices of the last yield events.")
+        .def("EventJumps", &S::EventJumps, "Change of potential index of the last yield events.")
 
         .def(
             "checkYieldBoundLeft",
@@ -147,11 +174,193 @@ auto construct_Array(T& self)
             "Check that 'the particle' is at least 'n' wells from the far-right.",
             py::arg("n") = 0)
 
+        .def("save", &S::save, "Write the full state to a binary file.", py::arg("filename"))
+
+        .def(
+            "load",
+            &S::load,
+            "Restore the full state from a binary file (see 'save').",
+            py::arg("filename"))
+
         .def("__repr__", [](const S&) {
             return "<GMatElastoPlasticQPot3d.Cartesian3d.Array>";
         });
 }
 
+// Setters (and getter) of points of type "Elastic"
+
+template <class S, class T>
+void construct_Array_Elastic(T& self)
+{
+    self.def(
+        "setElastic",
+        py::overload_cast<
+            const xt::xtensor<size_t, S::rank>&,
+            const xt::xtensor<size_t, S::rank>&,
+            const xt::xtensor<double, 1>&,
+            const xt::xtensor<double, 1>&>(&S::setElastic),
+        "Set specific entries 'Elastic'.",
+        py::arg("I"),
+        py::arg("idx"),
+        py::arg("K"),
+        py::arg("G"));
+
+    self.def(
+        "setElastic",
+        py::overload_cast<const xt::xtensor<size_t, S::rank>&, double, double>(
+            &S::setElastic),
+        "Set specific entries 'Elastic'.",
+        py::arg("I"),
+        py::arg("K"),
+        py::arg("G"));
+
+    self.def("getElastic", &S::getElastic, "Returns underlying Elastic model.");
+}
+
+// Setters (and getter) of points of type "Cusp"
+
+template <class S, class T>
+void construct_Array_Cusp(T& self)
+{
+    self.def(
+        "setCusp",
+        py::overload_cast<
+            const xt::xtensor<size_t, S::rank>&,
+            const xt::xtensor<size_t, S::rank>&,
+            const xt::xtensor<double, 1>&,
+            const xt::xtensor<double, 1>&,
+            const xt::xtensor<double, 2>&,
+            bool>(&S::setCusp),
+        "Set specific entries 'Cusp'.",
+        py::arg("I"),
+        py::arg("idx"),
+        py::arg("K"),
+        py::arg("G"),
+        py::arg("epsy"),
+        py::arg("init_elastic") = true);
+
+    self.def(
+        "setCusp",
+        py::overload_cast<
+            const xt::xtensor<size_t, S::rank>&,
+            double,
+            double,
+            const GMatElastoPlasticQPot3d::Cartesian3d::Procedural&>(&S::setCusp),
+        "Set specific entries 'Cusp', with procedurally generated landscapes.",
+        py::arg("I"),
+        py::arg("K"),
+        py::arg("G"),
+        py::arg("epsy"));
+
+    self.def(
+        "setCusp",
+        py::overload_cast<
+            const xt::xtensor<size_t, S::rank>&,
+            double,
+            double,
+            const GMatElastoPlasticQPot3d::Cartesian3d::Procedural&,
+            const xt::xtensor<size_t, S::rank>&,
+            const xt::xtensor<double, S::rank>&,
+            const xt::xtensor<double, S::rank + 2>&>(&S::setCusp),
+        "Set specific entries 'Cusp', with procedural landscapes, starting in a given well.",
+        py::arg("I"),
+        py::arg("K"),
+        py::arg("G"),
+        py::arg("epsy"),
+        py::arg("index"),
+        py::arg("epsy_l"),
+        py::arg("Eps"));
+
+    self.def(
+        "setCusp",
+        py::overload_cast<
+            const xt::xtensor<size_t, S::rank>&,
+            double,
+            double,
+            const xt::xtensor<double, 1>&,
+            bool>(&S::setCusp),
+        "Set specific entries 'Cusp'.",
+        py::arg("I"),
+        py::arg("K"),
+        py::arg("G"),
+        py::arg("epsy"),
+        py::arg("init_elastic") = true);
+
+    self.def("getCusp", &S::getCusp, "Returns underlying Cusp model.");
+}
+
+// Setters (and getter) of points of type "Smooth"
+
+template <class S, class T>
+void construct_Array_Smooth(T& self)
+{
+    self.def(
+        "setSmooth",
+        py::overload_cast<
+            const xt::xtensor<size_t, S::rank>&,
+            const xt::xtensor<size_t, S::rank>&,
+            const xt::xtensor<double, 1>&,
+            const xt::xtensor<double, 1>&,
+            const xt::xtensor<double, 2>&,
+            bool>(&S::setSmooth),
+        "Set specific entries 'Smooth'.",
+        py::arg("I"),
+        py::arg("idx"),
+        py::arg("K"),
+        py::arg("G"),
+        py::arg("epsy"),
+        py::arg("init_elastic") = true);
+
+    self.def(
+        "setSmooth",
+        py::overload_cast<
+            const xt::xtensor<size_t, S::rank>&,
+            double,
+            double,
+            const GMatElastoPlasticQPot3d::Cartesian3d::Procedural&>(&S::setSmooth),
+        "Set specific entries 'Smooth', with procedurally generated landscapes.",
+        py::arg("I"),
+        py::arg("K"),
+        py::arg("G"),
+        py::arg("epsy"));
+
+    self.def(
+        "setSmooth",
+        py::overload_cast<
+            const xt::xtensor<size_t, S::rank>&,
+            double,
+            double,
+            const GMatElastoPlasticQPot3d::Cartesian3d::Procedural&,
+            const xt::xtensor<size_t, S::rank>&,
+            const xt::xtensor<double, S::rank>&,
+            const xt::xtensor<double, S::rank + 2>&>(&S::setSmooth),
+        "Set specific entries 'Smooth', with procedural landscapes, starting in a given well.",
+        py::arg("I"),
+        py::arg("K"),
+        py::arg("G"),
+        py::arg("epsy"),
+        py::arg("index"),
+        py::arg("epsy_l"),
+        py::arg("Eps"));
+
+    self.def(
+        "setSmooth",
+        py::overload_cast<
+            const xt::xtensor<size_t, S::rank>&,
+            double,
+            double,
+            const xt::xtensor<double, 1>&,
+            bool>(&S::setSmooth),
+        "Set specific entries 'Smooth'.",
+        py::arg("I"),
+        py::arg("K"),
+        py::arg("G"),
+        py::arg("epsy"),
+        py::arg("init_elastic") = true);
+
+    self.def("getSmooth", &S::getSmooth, "Returns underlying Smooth model.");
+}
+
 template <class S, class T>
 void add_deviatoric_overloads(T& module)
 {
@@ -261,6 +470,20 @@ PYBIND11_MODULE(GMatElastoPlasticQPot3d, m)
             py::arg("epsy"),
             py::arg("init_elastic") = true)
 
+        .def(
+            py::init<
+                double,
+                double,
+                const xt::xtensor<double, 1>&,
+                const xt::xtensor<double, 2>&,
+                bool>(),
+            "Elasto-plastic material point, with 'cusp' potentials, at an initial strain.",
+            py::arg("K"),
+            py::arg("G"),
+            py::arg("epsy"),
+            py::arg("Eps"),
+            py::arg("init_elastic") = true)
+
         .def("K", &SM::Cusp::K, "Returns the bulk modulus.")
         .def("G", &SM::Cusp::G, "Returns the shear modulus.")
         .def("epsy", &SM::Cusp::epsy, "Returns the yield strains.")
@@ -299,6 +522,8 @@ PYBIND11_MODULE(GMatElastoPlasticQPot3d, m)
 
         .def("epsp", &SM::Cusp::epsp, "Returns equivalent plastic strain.")
         .def("energy", &SM::Cusp::energy, "Returns the energy, for last known strain.")
+        .def("epsd", &SM::Cusp::epsd, "Returns the equivalent strain, for last known strain.")
+        .def("sigd", &SM::Cusp::sigd, "Returns the equivalent stress, for last known strain.")
 
         .def("__repr__", [](const SM::Cusp&) {
             return "<GMatElastoPlasticQPot3d.Cartesian3d.Cusp>";
@@ -316,6 +541,20 @@ PYBIND11_MODULE(GMatElastoPlasticQPot3d, m)
             py::arg("epsy"),
             py::arg("init_elastic") = true)
 
+        .def(
+            py::init<
+                double,
+                double,
+                const xt::xtensor<double, 1>&,
+                const xt::xtensor<double, 2>&,
+                bool>(),
+            "Elasto-plastic material point, with 'smooth' potentials, at an initial strain.",
+            py::arg("K"),
+            py::arg("G"),
+            py::arg("epsy"),
+            py::arg("Eps"),
+            py::arg("init_elastic") = true)
+
         .def("K", &SM::Smooth::K, "Returns the bulk modulus.")
         .def("G", &SM::Smooth::G, "Returns the shear modulus.")
         .def("epsy", &SM::Smooth::epsy, "Returns the yield strains.")
@@ -354,6 +593,8 @@ PYBIND11_MODULE(GMatElastoPlasticQPot3d, m)
 
         .def("epsp", &SM::Smooth::epsp, "Returns equivalent plastic strain.")
         .def("energy", &SM::Smooth::energy, "Returns the energy, for last known strain.")
+        .def("epsd", &SM::Smooth::epsd, "Returns the equivalent strain, for last known strain.")
+        .def("sigd", &SM::Smooth::sigd, "Returns the equivalent stress, for last known strain.")
 
         .def("__repr__", [](const SM::Smooth&) {
             return "<GMatElastoPlasticQPot3d.Cartesian3d.Smooth>";
@@ -370,6 +611,45 @@ PYBIND11_MODULE(GMatElastoPlasticQPot3d, m)
         .value("Smooth", SM::Type::Smooth)
         .export_values();
 
+    // Procedural landscape
+
+    py::class_<SM::Procedural> procedural(sm, "Procedural");
+
+    py::enum_<SM::Procedural::Distribution>(procedural, "Distribution")
+        .value("Weibull", SM::Procedural::Weibull)
+        .value("Uniform", SM::Procedural::Uniform)
+        .value("Delta", SM::Procedural::Delta)
+        .export_values();
+
+    procedural
+        .def(
+            py::init<SM::Procedural::Distribution, double, double, double, uint64_t, size_t>(),
+            "Procedurally generated potential energy landscape.",
+            py::arg("distribution"),
+            py::arg("a"),
+            py::arg("b") = 0.0,
+            py::arg("offset") = 0.0,
+            py::arg("seed") = 0,
+            py::arg("window") = 1000)
+
+        .def(
+            "increment",
+            &SM::Procedural::increment,
+            "Yield strain increment 'epsy[n + 1] - epsy[n]' of point 'p'.",
+            py::arg("p"),
+            py::arg("n"))
+
+        .def_readwrite("distribution", &SM::Procedural::distribution)
+        .def_readwrite("a", &SM::Procedural::a)
+        .def_readwrite("b", &SM::Procedural::b)
+        .def_readwrite("offset", &SM::Procedural::offset)
+        .def_readwrite("seed", &SM::Procedural::seed)
+        .def_readwrite("window", &SM::Procedural::window)
+
+        .def("__repr__", [](const SM::Procedural&) {
+            return "<GMatElastoPlasticQPot3d.Cartesian3d.Procedural>";
+        });
+
     // Array
 
     py::class_<SM::Array<1>> array1d(sm, "Array1d");
@@ -379,4 +659,13 @@ PYBIND11_MODULE(GMatElastoPlasticQPot3d, m)
     construct_Array<SM::Array<1>>(array1d);
     construct_Array<SM::Array<2>>(array2d);
     construct_Array<SM::Array<3>>(array3d);
+    construct_Array_Elastic<SM::Array<1>>(array1d);
+    construct_Array_Elastic<SM::Array<2>>(array2d);
+    construct_Array_Elastic<SM::Array<3>>(array3d);
+    construct_Array_Cusp<SM::Array<1>>(array1d);
+    construct_Array_Cusp<SM::Array<2>>(array2d);
+    construct_Array_Cusp<SM::Array<3>>(array3d);
+    construct_Array_Smooth<SM::Array<1>>(array1d);
+    construct_Array_Smooth<SM::Array<2>>(array2d);
+    construct_Array_Smooth<SM::Array<3>>(array3d);
 }
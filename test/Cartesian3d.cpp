@@ -1,5 +1,10 @@
 
 #include <catch2/catch.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <unistd.h>
 #include <xtensor/xrandom.hpp>
 #include <GMatElastoPlasticQPot3d/Cartesian3d.h>
 #include <GMatTensor/Cartesian3d.h>
@@ -7,8 +12,54 @@
 namespace GM = GMatElastoPlasticQPot3d::Cartesian3d;
 namespace GT = GMatTensor::Cartesian3d;
 
+// Temporary directory, removed with the files named through "path" on destruction
+class TempDir {
+public:
+    TempDir()
+    {
+        const char* tmp = std::getenv("TMPDIR");
+        m_dir = std::string(tmp ? tmp : "/tmp") + "/GMatElastoPlasticQPot3d-XXXXXX";
+        REQUIRE(mkdtemp(&m_dir[0]) != nullptr);
+    }
+
+    ~TempDir()
+    {
+        for (auto& name : m_files) {
+            std::remove(name.c_str());
+        }
+        rmdir(m_dir.c_str());
+    }
+
+    std::string path(const std::string& name)
+    {
+        std::string ret = m_dir + "/" + name;
+        if (std::find(m_files.begin(), m_files.end(), ret) == m_files.end()) {
+            m_files.push_back(ret);
+        }
+        return ret;
+    }
+
+private:
+    std::string m_dir;
+    std::vector<std::string> m_files;
+};
+
 TEST_CASE("GMatElastoPlasticQPot3d::Cartesian3d", "Cartesian3d.h")
 {
+    // Fixture of several "Array" sections: "n" points of type Elastic, Cusp, and Smooth in blocks
+    // of 10 (the last point is unset)
+    auto setMixed = [](auto& mat, size_t n) {
+        xt::xtensor<size_t, 1> E = xt::zeros<size_t>({n});
+        xt::xtensor<size_t, 1> C = xt::zeros<size_t>({n});
+        xt::xtensor<size_t, 1> S = xt::zeros<size_t>({n});
+        for (size_t p = 0; p < n - 1; ++p) {
+            (p < 10 ? E : p < 20 ? C : S)(p) = 1;
+        }
+        mat.setElastic(E, 12.3, 45.6);
+        mat.setCusp(C, 12.3, 45.6, 0.005 + 0.01 * xt::arange<double>(10));
+        mat.setSmooth(S, 12.3, 45.6, 0.005 + 0.01 * xt::arange<double>(10));
+    };
+
     SECTION("Epsd - Tensor2")
     {
         auto A = GT::O2();
@@ -391,4 +442,1251 @@ TEST_CASE("GMatElastoPlasticQPot3d::Cartesian3d", "Cartesian3d.h")
             }
         }
     }
+
+    SECTION("Array - consistency with material points")
+    {
+        size_t nelem = 7;
+        size_t nip = 3;
+
+        GM::Array<2> mat({nelem, nip});
+
+        xt::xtensor<size_t, 2> type = xt::zeros<size_t>({nelem, nip});
+        xt::xtensor<size_t, 2> idx = xt::zeros<size_t>({nelem, nip});
+        xt::xtensor<double, 1> K = {11.0, 12.0, 13.0};
+        xt::xtensor<double, 1> G = {21.0, 22.0, 23.0};
+        xt::xtensor<double, 2> epsy = 1e-3 + 1e-3 * xt::random::rand<double>({3, 500});
+        for (size_t j = 0; j < epsy.shape(0); ++j) {
+            for (size_t k = 1; k < epsy.shape(1); ++k) {
+                epsy(j, k) += epsy(j, k - 1);
+            }
+        }
+
+        for (size_t e = 0; e < nelem; ++e) {
+            for (size_t q = 0; q < nip; ++q) {
+                type(e, q) = e % 3;
+                idx(e, q) = (e + q) % 3;
+            }
+        }
+
+        mat.setElastic(xt::equal(type, 0ul) * 1ul, idx, K, G);
+        mat.setCusp(xt::equal(type, 1ul) * 1ul, idx, K, G, epsy);
+        mat.setSmooth(xt::equal(type, 2ul) * 1ul, idx, K, G, epsy);
+
+        for (size_t inc = 0; inc < 5; ++inc) {
+
+            xt::xtensor<double, 4> eps = xt::random::randn<double>({nelem, nip, 3ul, 3ul});
+            eps *= 1e-2 * static_cast<double>(inc);
+            for (size_t e = 0; e < nelem; ++e) {
+                for (size_t q = 0; q < nip; ++q) {
+                    for (size_t i = 0; i < 3; ++i) {
+                        for (size_t j = i + 1; j < 3; ++j) {
+                            eps(e, q, j, i) = eps(e, q, i, j);
+                        }
+                    }
+                }
+            }
+
+            mat.setStrain(eps);
+
+            auto sig = mat.Stress();
+            auto energy = mat.Energy();
+            auto index = mat.CurrentIndex();
+            auto epsp = mat.Epsp();
+
+            for (size_t e = 0; e < nelem; ++e) {
+                for (size_t q = 0; q < nip; ++q) {
+                    size_t j = idx(e, q);
+                    xt::xtensor<double, 2> Eps = xt::view(eps, e, q);
+                    xt::xtensor<double, 2> Sig = xt::view(sig, e, q);
+                    if (type(e, q) == 0) {
+                        GM::Elastic point(K(j), G(j));
+                        point.setStrain(Eps);
+                        REQUIRE(xt::allclose(point.Stress(), Sig));
+                        REQUIRE(point.energy() == Approx(energy(e, q)));
+                    }
+                    else if (type(e, q) == 1) {
+                        GM::Cusp point(K(j), G(j), xt::view(epsy, j, xt::all()));
+                        point.setStrain(Eps);
+                        REQUIRE(xt::allclose(point.Stress(), Sig));
+                        REQUIRE(point.energy() == Approx(energy(e, q)));
+                        REQUIRE(point.currentIndex() == index(e, q));
+                        REQUIRE(point.epsp() == Approx(epsp(e, q)));
+                        REQUIRE(xt::allclose(mat.getCusp({e, q}).Stress(), Sig));
+                    }
+                    else {
+                        GM::Smooth point(K(j), G(j), xt::view(epsy, j, xt::all()));
+                        point.setStrain(Eps);
+                        REQUIRE(xt::allclose(point.Stress(), Sig));
+                        REQUIRE(point.energy() == Approx(energy(e, q)));
+                        REQUIRE(point.currentIndex() == index(e, q));
+                        REQUIRE(point.epsp() == Approx(epsp(e, q)));
+                        REQUIRE(xt::allclose(mat.getSmooth({e, q}).Stress(), Sig));
+                    }
+                }
+            }
+        }
+    }
+
+    SECTION("Array - batched kernels")
+    {
+        // points of one type are contiguous: most blocks use the batched kernels
+        size_t n = 43;
+        double K = 12.3;
+        double G = 45.6;
+
+        GM::Array<1> mat({n});
+
+        xt::xtensor<double, 1> epsy = 1e-3 + 1e-3 * xt::random::rand<double>({500});
+        for (size_t k = 1; k < epsy.size(); ++k) {
+            epsy(k) += epsy(k - 1);
+        }
+
+        xt::xtensor<size_t, 1> type = xt::zeros<size_t>({n});
+        for (size_t i = 0; i < n; ++i) {
+            type(i) = i < 18 ? 1 : (i < 35 ? 2 : 0);
+        }
+
+        mat.setElastic(xt::equal(type, 0ul) * 1ul, K, G);
+        mat.setCusp(xt::equal(type, 1ul) * 1ul, K, G, epsy);
+        mat.setSmooth(xt::equal(type, 2ul) * 1ul, K, G, epsy);
+
+        xt::xtensor<double, 3> eps = xt::random::randn<double>({n, 3ul, 3ul});
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                for (size_t k = j + 1; k < 3; ++k) {
+                    eps(i, k, j) = eps(i, j, k);
+                }
+            }
+        }
+        eps *= 1e-2;
+
+        // purely hydrostatic strain: "epsd == 0" in a batched block
+        for (size_t i : {3ul, 20ul}) {
+            xt::view(eps, i) = 1e-2 * GM::I2();
+        }
+
+        mat.setStrain(eps);
+
+        auto sig = mat.Stress();
+        auto index = mat.CurrentIndex();
+
+        for (size_t i = 0; i < n; ++i) {
+            xt::xtensor<double, 2> Eps = xt::view(eps, i);
+            xt::xtensor<double, 2> Sig = xt::view(sig, i);
+            if (type(i) == 0) {
+                GM::Elastic point(K, G);
+                point.setStrain(Eps);
+                REQUIRE(xt::allclose(point.Stress(), Sig));
+            }
+            else if (type(i) == 1) {
+                GM::Cusp point(K, G, epsy);
+                point.setStrain(Eps);
+                REQUIRE(xt::allclose(point.Stress(), Sig));
+                REQUIRE(point.currentIndex() == index(i));
+            }
+            else {
+                GM::Smooth point(K, G, epsy);
+                point.setStrain(Eps);
+                REQUIRE(xt::allclose(point.Stress(), Sig));
+                REQUIRE(point.currentIndex() == index(i));
+            }
+        }
+    }
+
+    SECTION("Tangent - Array")
+    {
+        size_t nelem = 3;
+        size_t nip = 2;
+
+        GM::Array<2> mat({nelem, nip});
+
+        xt::xtensor<double, 1> K = {11.0, 12.0, 13.0};
+        xt::xtensor<double, 1> G = {21.0, 22.0, 23.0};
+        xt::xtensor<size_t, 2> I = xt::ones<size_t>({nelem, nip});
+        xt::xtensor<size_t, 2> idx = xt::zeros<size_t>({nelem, nip});
+
+        for (size_t e = 0; e < nelem; ++e) {
+            for (size_t q = 0; q < nip; ++q) {
+                idx(e, q) = e;
+            }
+        }
+
+        mat.setCusp(I, idx, K, G, xt::ones<double>({3ul, 1ul}));
+
+        auto C = mat.Tangent();
+
+        for (size_t e = 0; e < nelem; ++e) {
+            for (size_t q = 0; q < nip; ++q) {
+                xt::xtensor<double, 4> Cq = xt::view(C, e, q);
+                REQUIRE(xt::allclose(Cq, K(e) * GM::II() + 2.0 * G(e) * GM::I4d()));
+            }
+        }
+    }
+
+    SECTION("Tangent - Array - compact forms")
+    {
+        GM::Array<1> mat({4});
+
+        xt::xtensor<size_t, 1> I = {1, 1, 0, 0};
+        xt::xtensor<size_t, 1> J = {0, 0, 1, 0};
+        xt::xtensor<size_t, 1> idx = {0, 1, 0, 0};
+        xt::xtensor<double, 1> K = {11.0, 12.0};
+        xt::xtensor<double, 1> G = {21.0, 22.0};
+        mat.setElastic(I, idx, K, G);
+        mat.setCusp(J, 13.0, 23.0, xt::xtensor<double, 1>{1.0, 2.0});
+
+        xt::xtensor<double, 3> dEps = xt::random::randn<double>({4, 3, 3});
+        xt::xtensor<double, 2> KG = mat.TangentIsotropic();
+        xt::xtensor<double, 5> C = mat.Tangent();
+        xt::xtensor<double, 3> Sig = mat.TangentDdot(dEps);
+        xt::xtensor<double, 3> Voigt = mat.TangentVoigt();
+        xt::xtensor<double, 3> Mandel = mat.TangentMandel();
+
+        REQUIRE(xt::allclose(KG, xt::xtensor<double, 2>{{11, 21}, {12, 22}, {13, 23}, {0, 0}}));
+
+        std::array<size_t, 6> a = {0, 1, 2, 1, 0, 0};
+        std::array<size_t, 6> b = {0, 1, 2, 2, 2, 1};
+
+        for (size_t p = 0; p < 4; ++p) {
+            for (size_t i = 0; i < 3; ++i) {
+                for (size_t j = 0; j < 3; ++j) {
+                    double sig = 0.0;
+                    for (size_t k = 0; k < 3; ++k) {
+                        for (size_t l = 0; l < 3; ++l) {
+                            sig += C(p, i, j, k, l) * dEps(p, l, k);
+                        }
+                    }
+                    REQUIRE(Sig(p, i, j) == Approx(sig).margin(1e-12));
+                }
+            }
+
+            for (size_t m = 0; m < 6; ++m) {
+                for (size_t n = 0; n < 6; ++n) {
+                    double w = (m < 3 ? 1.0 : std::sqrt(2.0)) * (n < 3 ? 1.0 : std::sqrt(2.0));
+                    double c = C(p, a[m], b[m], a[n], b[n]);
+                    REQUIRE(Mandel(p, m, n) == Approx(w * c).margin(1e-12));
+                    REQUIRE(Voigt(p, m, n) == Approx(c).margin(1e-12));
+                }
+            }
+        }
+    }
+
+    SECTION("Array - shared landscapes")
+    {
+        GM::Array<1> mat({4});
+
+        xt::xtensor<size_t, 1> I = xt::ones<size_t>({4});
+        xt::xtensor<size_t, 1> idx = {2, 0, 2, 2};
+        xt::xtensor<double, 1> K = {12.3, 12.3, 12.3};
+        xt::xtensor<double, 1> G = {45.6, 45.6, 45.6};
+        xt::xtensor<double, 2> epsy = {{0.01, 0.03, 0.10}, {0.0, 0.0, 0.0}, {0.01, 0.02, 0.05}};
+        mat.setCusp(I, idx, K, G, epsy);
+
+        xt::xtensor<double, 3> Eps = xt::zeros<double>({4, 3, 3});
+        for (size_t p = 0; p < 4; ++p) {
+            Eps(p, 0, 1) = Eps(p, 1, 0) = 0.01 * static_cast<double>(p + 1);
+        }
+        mat.setStrain(Eps);
+        xt::xtensor<double, 3> Sig = mat.Stress();
+        xt::xtensor<size_t, 1> index = mat.CurrentIndex();
+
+        for (size_t p = 0; p < 4; ++p) {
+            xt::xtensor<double, 1> y = xt::view(epsy, idx(p), xt::all());
+            GM::Cusp point(12.3, 45.6, y);
+            xt::xtensor<double, 2> eps = xt::view(Eps, p);
+            point.setStrain(eps);
+            xt::xtensor<double, 2> sig = xt::view(Sig, p);
+            REQUIRE(index(p) == point.currentIndex());
+            REQUIRE(xt::allclose(sig, point.Stress()));
+            REQUIRE(xt::allclose(mat.getCusp({p}).epsy(), point.epsy()));
+        }
+    }
+
+    SECTION("Array - procedural landscapes")
+    {
+        size_t n = 5;
+        xt::xtensor<size_t, 1> I = xt::ones<size_t>({n});
+
+        // "Delta": equivalent to a stored landscape with equidistant yield strains
+        GM::Array<1> stored({n});
+        GM::Array<1> delta({n});
+        stored.setCusp(I, 12.3, 45.6, 0.005 + 0.01 * xt::arange<double>(1000));
+        delta.setCusp(I, 12.3, 45.6, GM::Procedural(GM::Procedural::Delta, 0.01, 0.0, 0.0, 0, 8));
+
+        // "Weibull": the result does not depend on the window
+        // (up to round-off: moving the window back subtracts increments)
+        GM::Procedural weibull(GM::Procedural::Weibull, 2.0, 0.01, 1e-3, 7, 8);
+        GM::Array<1> small({n});
+        GM::Array<1> large({n});
+        small.setSmooth(I, 12.3, 45.6, weibull);
+        weibull.window = 1000;
+        large.setSmooth(I, 12.3, 45.6, weibull);
+
+        xt::xtensor<double, 2> Eps = xt::zeros<double>({3, 3});
+        xt::xtensor<double, 3> eps = xt::zeros<double>({n, 3ul, 3ul});
+        std::vector<double> gamma = {0.0, 0.0213, 0.1077, 0.5031, 0.3017, 0.0213, 0.0, 1.0013};
+
+        for (auto& g : gamma) {
+            for (size_t p = 0; p < n; ++p) {
+                Eps(0, 1) = Eps(1, 0) = g * static_cast<double>(p + 1);
+                xt::view(eps, p) = Eps;
+            }
+
+            stored.setStrain(eps);
+            delta.setStrain(eps);
+            small.setStrain(eps);
+            large.setStrain(eps);
+
+            REQUIRE(xt::all(xt::equal(stored.CurrentIndex(), delta.CurrentIndex())));
+            REQUIRE(xt::allclose(stored.CurrentYieldLeft(), delta.CurrentYieldLeft()));
+            REQUIRE(xt::allclose(stored.Stress(), delta.Stress()));
+            REQUIRE(xt::all(xt::equal(small.CurrentIndex(), large.CurrentIndex())));
+            REQUIRE(xt::allclose(small.CurrentYieldLeft(), large.CurrentYieldLeft()));
+            REQUIRE(xt::allclose(small.CurrentYieldRight(), large.CurrentYieldRight()));
+            REQUIRE(delta.checkYieldBoundRight(100));
+        }
+
+        REQUIRE(small.CurrentIndex()(0) > 50);
+    }
+
+    SECTION("Array - landscape extension")
+    {
+        size_t n = 4;
+        xt::xtensor<size_t, 1> I = xt::ones<size_t>({n});
+        xt::xtensor<double, 1> epsy = 0.005 + 0.01 * xt::arange<double>(5);
+
+        GM::Array<1> ref({n});
+        GM::Array<1> automatic({n});
+        GM::Array<1> manual({n});
+        ref.setCusp(I, 12.3, 45.6, 0.005 + 0.01 * xt::arange<double>(1000));
+        automatic.setCusp(I, 12.3, 45.6, epsy);
+        manual.setCusp(I, 12.3, 45.6, epsy);
+        automatic.setYieldExtension(2, GM::Procedural(GM::Procedural::Delta, 0.01));
+
+        xt::xtensor<double, 2> Eps = xt::zeros<double>({3, 3});
+        xt::xtensor<double, 3> eps = xt::zeros<double>({n, 3ul, 3ul});
+        std::vector<double> gamma = {0.0, 0.0213, 0.1077, 0.3017, 0.5031, 1.0013};
+
+        for (auto& g : gamma) {
+            for (size_t p = 0; p < n; ++p) {
+                Eps(0, 1) = Eps(1, 0) = g * static_cast<double>(p + 1);
+                xt::view(eps, p) = Eps;
+            }
+
+            ref.setStrain(eps);
+            automatic.setStrain(eps);
+            manual.setStrain(eps);
+            manual.extendYieldRight(2, [](size_t, size_t) { return 0.01; });
+
+            REQUIRE(automatic.checkYieldBoundRight(2));
+            REQUIRE(manual.checkYieldBoundRight(2));
+            REQUIRE(xt::all(xt::equal(ref.CurrentIndex(), automatic.CurrentIndex())));
+            REQUIRE(xt::all(xt::equal(ref.CurrentIndex(), manual.CurrentIndex())));
+            REQUIRE(xt::allclose(ref.CurrentYieldLeft(), automatic.CurrentYieldLeft()));
+            REQUIRE(xt::allclose(ref.CurrentYieldRight(), manual.CurrentYieldRight()));
+            REQUIRE(xt::allclose(ref.Stress(), automatic.Stress()));
+            REQUIRE(xt::allclose(ref.Stress(), manual.Stress()));
+        }
+
+        // the landscape is shared, and extended for all points: the last step only extends the
+        // points within "2" wells of its far-right
+        REQUIRE(automatic.nextended() == 2);
+
+        // the left margin counts the stored wells only (wells are discarded by the extension)
+        GM::Array<1> mat({1});
+        mat.setCusp(xt::ones<size_t>({1}), 12.3, 45.6, 0.5 + xt::arange<double>(10));
+        xt::xtensor<double, 3> e = xt::zeros<double>({1ul, 3ul, 3ul});
+        e(0, 0, 1) = e(0, 1, 0) = 8.0;
+        mat.setStrain(e);
+        REQUIRE(mat.extendYieldRight(2, [](size_t, size_t) { return 1.0; }) == 1);
+        REQUIRE(mat.CurrentIndex()(0) == 8);
+        REQUIRE(mat.checkYieldBoundLeft(1));
+        REQUIRE(!mat.checkYieldBoundLeft(5));
+        REQUIRE(mat.yieldMarginLeft() == 2);
+
+        // unloading beyond the stored wells is flagged
+        e(0, 0, 1) = e(0, 1, 0) = 3.0;
+        mat.setStrain(e);
+        REQUIRE(!mat.checkYieldBoundLeft());
+        REQUIRE(mat.yieldMarginLeft() == 0);
+        REQUIRE(xt::all(xt::equal(mat.OffendersYieldBoundLeft(), xt::xtensor<size_t, 1>{0})));
+
+        // a shared landscape stays shared (extended with the increments of its first point),
+        // in place or in a new slot (old slots are reclaimed)
+        GM::Array<1> shared({2});
+        shared.setCusp(xt::ones<size_t>({2}), 12.3, 45.6, 0.5 + xt::arange<double>(10));
+        xt::xtensor<double, 3> f = xt::zeros<double>({2ul, 3ul, 3ul});
+        f(0, 0, 1) = f(0, 1, 0) = 6.0;
+        f(1, 0, 1) = f(1, 1, 0) = 8.0;
+        shared.setStrain(f);
+        auto inc = [](size_t p, size_t) { return 1.0 + static_cast<double>(p); };
+
+        for (size_t m : {2, 6, 12}) {
+            REQUIRE(shared.extendYieldRight(m, inc) > 0);
+            REQUIRE(shared.checkYieldBoundRight(m));
+            REQUIRE(xt::all(xt::equal(shared.CurrentIndex(), xt::xtensor<size_t, 1>{6, 8})));
+            auto epsy = shared.getCusp({0}).epsy();
+            REQUIRE(xt::allclose(shared.getCusp({1}).epsy(), epsy));
+            REQUIRE(xt::allclose(epsy, epsy(0) + xt::arange<double>(epsy.size())));
+        }
+    }
+
+    SECTION("Array - yield bound margins and offenders")
+    {
+        GM::Array<1> mat({5});
+
+        xt::xtensor<size_t, 1> E = {1, 0, 0, 0, 0};
+        xt::xtensor<size_t, 1> C = {0, 1, 1, 1, 0};
+        xt::xtensor<size_t, 1> P = {0, 0, 0, 0, 1};
+        mat.setElastic(E, 12.3, 45.6);
+        mat.setCusp(C, 12.3, 45.6, 0.005 + 0.01 * xt::arange<double>(10));
+        mat.setSmooth(P, 12.3, 45.6, GM::Procedural(GM::Procedural::Delta, 0.01));
+
+        // epsd: 0.0, 0.0, 0.031, 0.072, 0.5
+        xt::xtensor<double, 3> eps = xt::zeros<double>({5ul, 3ul, 3ul});
+        std::vector<double> gamma = {0.0, 0.0, 0.031, 0.072, 0.5};
+        for (size_t p = 0; p < 5; ++p) {
+            eps(p, 0, 1) = eps(p, 1, 0) = gamma[p];
+        }
+        mat.setStrain(eps);
+
+        // indices: -, 0, 3, 7 (of 11 yield strains), 50
+        REQUIRE(mat.yieldMarginLeft() == 0);
+        REQUIRE(mat.yieldMarginRight() == 3);
+        REQUIRE(mat.checkYieldBoundRight(2));
+        REQUIRE(!mat.checkYieldBoundRight(3));
+        REQUIRE(!mat.checkYieldBoundLeft(0));
+        REQUIRE(xt::all(xt::equal(mat.OffendersYieldBoundLeft(0), xt::xtensor<size_t, 1>{1})));
+        REQUIRE(xt::all(xt::equal(mat.OffendersYieldBoundLeft(3), xt::xtensor<size_t, 1>{1, 2})));
+        REQUIRE(mat.OffendersYieldBoundRight(2).size() == 0);
+        REQUIRE(xt::all(xt::equal(mat.OffendersYieldBoundRight(7), xt::xtensor<size_t, 1>{2, 3})));
+
+        // out of range: beyond the last yield strain (0.095)
+        eps(3, 0, 1) = eps(3, 1, 0) = 100.0;
+        mat.setStrain(eps);
+
+        REQUIRE(mat.yieldMarginRight() == 0);
+        REQUIRE(!mat.checkYieldBoundRight());
+        REQUIRE(xt::all(xt::equal(mat.OffendersYieldBoundRight(0), xt::xtensor<size_t, 1>{3})));
+        REQUIRE(xt::all(xt::equal(mat.OffendersYieldBoundLeft(0), xt::xtensor<size_t, 1>{1})));
+
+        eps(3, 0, 1) = eps(3, 1, 0) = 0.072;
+        mat.setStrain(eps);
+
+        REQUIRE(mat.yieldMarginRight() == 3);
+    }
+
+    SECTION("Array - yield events")
+    {
+        size_t n = 21;
+        GM::Array<1> mat({n});
+
+        xt::xtensor<size_t, 1> E = xt::zeros<size_t>({n});
+        xt::xtensor<size_t, 1> C = xt::zeros<size_t>({n});
+        xt::xtensor<size_t, 1> S = xt::zeros<size_t>({n});
+        for (size_t p = 0; p < n; ++p) {
+            (p % 3 == 0 ? E : p % 3 == 1 ? C : S)(p) = 1;
+        }
+        mat.setElastic(E, 12.3, 45.6);
+        mat.setCusp(C, 12.3, 45.6, 0.005 + 0.01 * xt::arange<double>(8));
+        mat.setSmooth(S, 12.3, 45.6, GM::Procedural(GM::Procedural::Weibull, 2.0, 0.01, 0.0, 1, 8));
+        mat.setYieldExtension(2, GM::Procedural(GM::Procedural::Uniform, 0.005, 0.015));
+        mat.setRecordEvents();
+
+        xt::xtensor<double, 3> eps = xt::zeros<double>({n, 3ul, 3ul});
+        std::vector<double> gamma = {0.01, 0.02, 0.03, 0.1, 0.08, 0.3, 0.0};
+
+        for (auto& g : gamma) {
+            xt::xtensor<size_t, 1> index = mat.CurrentIndex();
+
+            for (size_t p = 0; p < n; ++p) {
+                eps(p, 0, 1) = eps(p, 1, 0) = g * (1.0 + 0.1 * static_cast<double>(p));
+            }
+            mat.setStrain(eps);
+
+            xt::xtensor<size_t, 1> current = mat.CurrentIndex();
+            std::vector<size_t> points;
+            std::vector<ptrdiff_t> jumps;
+
+            for (size_t p = 0; p < n; ++p) {
+                if (current(p) != index(p)) {
+                    points.push_back(p);
+                    jumps.push_back(
+                        static_cast<ptrdiff_t>(current(p)) - static_cast<ptrdiff_t>(index(p)));
+                }
+            }
+
+            REQUIRE(points.size() > 0);
+            REQUIRE(mat.EventPoints().size() == points.size());
+            REQUIRE(std::equal(points.cbegin(), points.cend(), mat.EventPoints().cbegin()));
+            REQUIRE(std::equal(jumps.cbegin(), jumps.cend(), mat.EventJumps().cbegin()));
+        }
+    }
+
+    SECTION("Array - distance to yield")
+    {
+        size_t n = 9;
+        GM::Array<1> mat({n});
+
+        xt::xtensor<size_t, 1> E = xt::zeros<size_t>({n});
+        xt::xtensor<size_t, 1> C = xt::ones<size_t>({n});
+        E(0) = 1;
+        C(0) = 0;
+        mat.setElastic(E, 12.3, 45.6);
+        mat.setCusp(C, 12.3, 45.6, 0.005 + 0.01 * xt::arange<double>(100));
+
+        xt::xtensor<double, 3> Eps = xt::zeros<double>({n, 3ul, 3ul});
+        xt::xtensor<double, 3> dEps = xt::zeros<double>({n, 3ul, 3ul});
+        for (size_t p = 0; p < n; ++p) {
+            double s = (p % 2 == 0) ? 1.0 : -1.0; // loading or unloading
+            Eps(p, 0, 1) = Eps(p, 1, 0) = 0.1 + 0.013 * static_cast<double>(p);
+            Eps(p, 0, 0) = 0.02;
+            dEps(p, 0, 1) = dEps(p, 1, 0) = s * 0.01;
+            dEps(p, 1, 1) = 0.001 * static_cast<double>(p);
+        }
+        mat.setStrain(Eps);
+
+        xt::xtensor<double, 1> t = mat.DistanceToYield(dEps);
+        xt::xtensor<size_t, 1> index = mat.CurrentIndex();
+        auto tmin = mat.minDistanceToYield(dEps);
+
+        REQUIRE(std::isinf(t(0)));
+        REQUIRE(tmin.first == Approx(xt::amin(t)()));
+        REQUIRE(t(tmin.second) == tmin.first);
+
+        for (auto& f : {0.999, 1.001}) {
+            xt::xtensor<double, 3> eps = Eps;
+            for (size_t p = 1; p < n; ++p) {
+                for (size_t i = 0; i < 3; ++i) {
+                    for (size_t j = 0; j < 3; ++j) {
+                        eps(p, i, j) += f * t(p) * dEps(p, i, j);
+                    }
+                }
+            }
+            mat.setStrain(eps);
+            xt::xtensor<size_t, 1> current = mat.CurrentIndex();
+            for (size_t p = 1; p < n; ++p) {
+                REQUIRE((current(p) == index(p)) == (f < 1.0));
+            }
+        }
+    }
+
+    SECTION("Array - fused setStrain")
+    {
+        size_t n = 30;
+        GM::Array<1> mat({n});
+        GM::Array<1> fused({n});
+
+        for (auto* m : {&mat, &fused}) {
+            setMixed(*m, n);
+            m->setYieldExtension(2, GM::Procedural(GM::Procedural::Delta, 0.01));
+        }
+
+        xt::xtensor<double, 3> Sig = xt::empty<double>({n, 3ul, 3ul});
+        xt::xtensor<double, 1> U = xt::empty<double>({n});
+        xt::xtensor<double, 1> epsp = xt::empty<double>({n});
+        xt::xtensor<size_t, 1> index = xt::empty<size_t>({n});
+
+        for (auto& g : {0.01, 0.05, 0.3}) {
+            xt::xtensor<double, 3> eps = 0.01 * xt::random::randn<double>({n, 3ul, 3ul});
+            for (size_t p = 0; p < n; ++p) {
+                eps(p, 0, 1) = eps(p, 1, 0) = g * static_cast<double>(p);
+                eps(p, 0, 2) = eps(p, 2, 0);
+                eps(p, 1, 2) = eps(p, 2, 1);
+            }
+
+            mat.setStrain(eps);
+            fused.setStrainPtr(eps.data(), Sig.data(), U.data(), epsp.data(), index.data());
+
+            REQUIRE(xt::allclose(Sig, mat.Stress()));
+            REQUIRE(xt::allclose(U, mat.Energy()));
+            REQUIRE(xt::allclose(epsp, mat.Epsp()));
+            REQUIRE(xt::all(xt::equal(index, mat.CurrentIndex())));
+
+            fused.setStrain(eps, Sig, U);
+
+            REQUIRE(xt::allclose(Sig, mat.Stress()));
+            REQUIRE(xt::allclose(U, mat.Energy()));
+        }
+    }
+
+    SECTION("Array - incremental setStrain on a subset")
+    {
+        size_t n = 30;
+        GM::Array<1> mat({n});
+        GM::Array<1> sub({n});
+        GM::Array<1> sym({n}); // input converted point-by-point
+
+        for (auto* m : {&mat, &sub, &sym}) {
+            setMixed(*m, n);
+            m->setYieldExtension(2, GM::Procedural(GM::Procedural::Delta, 0.01));
+            m->setRecordEvents();
+        }
+
+        sym.setStorageMandel();
+
+        // active region: every third point (and the unset point), by index or by mask
+        xt::xtensor<size_t, 1> index = xt::empty<size_t>({11ul});
+        xt::xtensor<size_t, 1> I = xt::zeros<size_t>({n});
+        for (size_t p = 0; p < 10; ++p) {
+            index(p) = 3 * p;
+            I(3 * p) = 1;
+        }
+        index(10) = n - 1;
+        I(n - 1) = 1;
+
+        xt::xtensor<double, 3> eps = xt::zeros<double>({n, 3ul, 3ul});
+
+        for (auto& g : {0.0213, 0.1077, 0.3017}) {
+            for (size_t p = 0; p < 10; ++p) {
+                size_t i = 3 * p;
+                eps(i, 0, 0) = 0.01 * g;
+                eps(i, 0, 1) = eps(i, 1, 0) = g * static_cast<double>(p + 1);
+                eps(i, 1, 2) = eps(i, 2, 1) = 0.1 * g;
+            }
+
+            mat.setStrain(eps);
+
+            for (auto* m : {&sub, &sym}) {
+                if (g < 0.1) {
+                    m->setStrainAt(index, eps);
+                }
+                else {
+                    m->setStrainWhere(I, eps);
+                }
+            }
+
+            REQUIRE(xt::allclose(sub.Stress(), mat.Stress()));
+            REQUIRE(xt::allclose(sym.Stress(), mat.Stress()));
+            REQUIRE(xt::all(xt::equal(sym.CurrentIndex(), mat.CurrentIndex())));
+            REQUIRE(xt::allclose(sub.Energy(), mat.Energy()));
+            REQUIRE(xt::all(xt::equal(sub.CurrentIndex(), mat.CurrentIndex())));
+            REQUIRE(sub.nextended() == mat.nextended());
+
+            xt::xtensor<size_t, 1> points = mat.EventPoints();
+            xt::xtensor<ptrdiff_t, 1> jumps = mat.EventJumps();
+            REQUIRE(points.size() > 0);
+            REQUIRE(sub.EventPoints().size() == points.size());
+            REQUIRE(xt::all(xt::equal(sub.EventPoints(), points)));
+            REQUIRE(xt::all(xt::equal(sub.EventJumps(), jumps)));
+
+            xt::xtensor<double, 3> Sig = mat.Stress();
+            xt::xtensor<double, 1> U = mat.Energy();
+            xt::xtensor<double, 3> SigAt = sub.StressAt(index);
+            xt::xtensor<double, 1> UAt = sub.EnergyAt(index);
+
+            for (size_t p = 0; p < index.size(); ++p) {
+                REQUIRE(UAt(p) == Approx(U(index(p))));
+                for (size_t a = 0; a < 3; ++a) {
+                    for (size_t b = 0; b < 3; ++b) {
+                        REQUIRE(SigAt(p, a, b) == Approx(Sig(index(p), a, b)));
+                    }
+                }
+            }
+        }
+    }
+
+    SECTION("Array - bound external storage")
+    {
+        size_t n = 30;
+        GM::Array<1> mat({n});
+        GM::Array<1> bound({n});
+
+        setMixed(mat, n);
+        setMixed(bound, n);
+
+        xt::xtensor<double, 3> eps = xt::zeros<double>({n, 3ul, 3ul});
+        for (size_t p = 0; p < n; ++p) {
+            eps(p, 0, 1) = eps(p, 1, 0) = 0.0213 * static_cast<double>(p);
+        }
+
+        mat.setStrain(eps);
+        bound.setStrain(eps);
+
+        // binding copies the current state to the buffers
+        xt::xtensor<double, 3> Eps = xt::zeros<double>({n, 3ul, 3ul});
+        xt::xtensor<double, 3> Sig = xt::zeros<double>({n, 3ul, 3ul});
+        bound.bindStorage(Eps, Sig);
+        REQUIRE(bound.isBound());
+        REQUIRE(xt::allclose(Eps, mat.Strain()));
+        REQUIRE(xt::allclose(Sig, mat.Stress()));
+
+        for (auto& g : {0.1077, 0.3017, 0.0213}) {
+            for (size_t p = 0; p < n - 1; ++p) { // the bound strain of unset points is kept
+                eps(p, 0, 1) = eps(p, 1, 0) = g * static_cast<double>(p);
+                eps(p, 2, 2) = 0.01 * g;
+                Eps(p, 0, 1) = Eps(p, 1, 0) = g * static_cast<double>(p);
+                Eps(p, 2, 2) = 0.01 * g;
+            }
+
+            mat.setStrain(eps);
+            bound.setStrain();
+
+            REQUIRE(xt::allclose(Sig, mat.Stress()));
+            REQUIRE(xt::allclose(bound.Strain(), mat.Strain()));
+            REQUIRE(xt::allclose(bound.Stress(), mat.Stress()));
+            REQUIRE(xt::allclose(bound.Energy(), mat.Energy()));
+            REQUIRE(xt::all(xt::equal(bound.CurrentIndex(), mat.CurrentIndex())));
+        }
+
+        // the state survives unbinding
+        bound.unbindStorage();
+        REQUIRE(!bound.isBound());
+        Sig.fill(0.0);
+        REQUIRE(xt::allclose(bound.Stress(), mat.Stress()));
+        REQUIRE(xt::allclose(bound.Strain(), mat.Strain()));
+    }
+
+    SECTION("Array - Mandel storage")
+    {
+        size_t n = 30;
+        GM::Array<1> mat({n});
+        GM::Array<1> sym({n});
+
+        setMixed(mat, n);
+        setMixed(sym, n);
+
+        sym.setStorageMandel();
+        REQUIRE(sym.isStorageMandel());
+
+        xt::xtensor<double, 3> Sig = xt::empty<double>({n, 3ul, 3ul});
+        xt::xtensor<double, 1> U = xt::empty<double>({n});
+
+        for (auto& g : {0.0213, 0.1077, 0.3017}) {
+            xt::xtensor<double, 3> eps = 0.01 * xt::random::randn<double>({n, 3ul, 3ul});
+            for (size_t p = 0; p < n; ++p) {
+                eps(p, 0, 1) = eps(p, 1, 0) = g * static_cast<double>(p);
+                eps(p, 0, 2) = eps(p, 2, 0);
+                eps(p, 1, 2) = eps(p, 2, 1);
+            }
+
+            mat.setStrain(eps);
+            xt::xtensor<double, 2> eps_m = mat.StrainMandel();
+            xt::xtensor<double, 2> sig_m = mat.StressMandel();
+
+            for (size_t p = 0; p < n - 1; ++p) {
+                REQUIRE(eps_m(p, 0) == Approx(eps(p, 0, 0)));
+                REQUIRE(eps_m(p, 5) == Approx(std::sqrt(2.0) * eps(p, 0, 1)));
+            }
+
+            sym.setStrainMandel(eps_m);
+            REQUIRE(xt::allclose(sym.StressMandel(), sig_m));
+            REQUIRE(xt::allclose(sym.Stress(), mat.Stress()));
+            REQUIRE(xt::allclose(sym.Strain(), mat.Strain()));
+            REQUIRE(xt::allclose(sym.Energy(), mat.Energy()));
+            REQUIRE(xt::all(xt::equal(sym.CurrentIndex(), mat.CurrentIndex())));
+
+            // "[..., 3, 3]" interface, and raw buffers in storage format
+            sym.setStrain(eps, Sig, U);
+            REQUIRE(xt::allclose(Sig, mat.Stress()));
+            REQUIRE(xt::allclose(U, mat.Energy()));
+
+            xt::xtensor<double, 2> sig = xt::zeros<double>({n, 6ul});
+            sym.setStrainPtr(eps_m.data(), sig.data());
+            REQUIRE(xt::allclose(sig, sig_m));
+        }
+
+        sym.setStorageMandel(false);
+        REQUIRE(xt::allclose(sym.Stress(), mat.Stress()));
+        REQUIRE(xt::allclose(sym.Strain(), mat.Strain()));
+    }
+
+    SECTION("Array - plane strain storage")
+    {
+        size_t n = 30;
+        GM::Array<1> mat({n});
+        GM::Array<1> plane({n});
+
+        setMixed(mat, n);
+        setMixed(plane, n);
+
+        plane.setStoragePlaneStrain();
+        REQUIRE(plane.isStoragePlaneStrain());
+        REQUIRE(!plane.isStorageMandel());
+
+        xt::xtensor<double, 3> Sig = xt::empty<double>({n, 3ul, 3ul});
+        xt::xtensor<double, 1> U = xt::empty<double>({n});
+
+        for (auto& g : {0.0213, 0.1077, 0.3017}) {
+            xt::xtensor<double, 3> eps = 0.01 * xt::random::randn<double>({n, 3ul, 3ul});
+            for (size_t p = 0; p < n; ++p) {
+                eps(p, 0, 1) = eps(p, 1, 0) = g * static_cast<double>(p);
+                eps(p, 0, 2) = eps(p, 2, 0) = eps(p, 1, 2) = eps(p, 2, 1) = 0.0;
+            }
+
+            mat.setStrain(eps);
+            xt::xtensor<double, 2> eps_p = mat.StrainPlane();
+            xt::xtensor<double, 2> sig_p = mat.StressPlane();
+
+            for (size_t p = 0; p < n - 1; ++p) {
+                REQUIRE(eps_p(p, 1) == eps(p, 0, 1));
+                REQUIRE(eps_p(p, 2) == eps(p, 1, 1));
+                REQUIRE(eps_p(p, 3) == eps(p, 2, 2));
+            }
+
+            // identical to the "[..., 3, 3]" embedding
+            plane.setStrainPlane(eps_p);
+            REQUIRE(xt::all(xt::equal(plane.StressPlane(), sig_p)));
+            REQUIRE(xt::all(xt::equal(plane.Stress(), mat.Stress())));
+            REQUIRE(xt::allclose(plane.Strain(), mat.Strain()));
+            REQUIRE(xt::allclose(plane.Energy(), mat.Energy()));
+            REQUIRE(xt::all(xt::equal(plane.CurrentIndex(), mat.CurrentIndex())));
+
+            // "[..., 3, 3]" interface, and raw buffers in storage format
+            plane.setStrain(eps, Sig, U);
+            REQUIRE(xt::allclose(Sig, mat.Stress()));
+            REQUIRE(xt::allclose(U, mat.Energy()));
+
+            xt::xtensor<double, 2> sig = xt::zeros<double>({n, 4ul});
+            plane.setStrainPtr(eps_p.data(), sig.data());
+            REQUIRE(xt::allclose(sig, sig_p));
+        }
+
+        plane.setStorageMandel();
+        REQUIRE(plane.isStorageMandel());
+        REQUIRE(xt::allclose(plane.Stress(), mat.Stress()));
+        plane.setStoragePlaneStrain(false);
+        REQUIRE(xt::allclose(plane.Stress(), mat.Stress()));
+        REQUIRE(xt::allclose(plane.Strain(), mat.Strain()));
+    }
+
+    SECTION("Array - mixed precision")
+    {
+        size_t n = 30;
+        GM::Array<1> mat({n});
+        GM::Array<1, float> mixed({n});
+
+        xt::xtensor<size_t, 1> E = xt::zeros<size_t>({n});
+        xt::xtensor<size_t, 1> C = xt::zeros<size_t>({n});
+        xt::xtensor<size_t, 1> S = xt::zeros<size_t>({n});
+        xt::xtensor<size_t, 1> P = xt::zeros<size_t>({n});
+        for (size_t p = 0; p < n - 1; ++p) {
+            (p < 8 ? E : p < 15 ? C : p < 22 ? S : P)(p) = 1; // last point unset
+        }
+
+        GM::Procedural gen(GM::Procedural::Weibull, 2.0, 0.05, 0.001, 7, 8);
+
+        mat.setElastic(E, 12.3, 45.6);
+        mat.setCusp(C, 12.3, 45.6, 0.005 + 0.01 * xt::arange<double>(10));
+        mat.setSmooth(S, 12.3, 45.6, 0.005 + 0.01 * xt::arange<double>(10));
+        mat.setCusp(P, 12.3, 45.6, gen);
+        mixed.setElastic(E, 12.3, 45.6);
+        mixed.setCusp(C, 12.3, 45.6, 0.005 + 0.01 * xt::arange<double>(10));
+        mixed.setSmooth(S, 12.3, 45.6, 0.005 + 0.01 * xt::arange<double>(10));
+        mixed.setCusp(P, 12.3, 45.6, gen);
+
+        // accuracy bounds with respect to the "double" reference (relative to "float" epsilon)
+        double rtol = 1e-5;
+        double atol = 1e-6;
+
+        for (auto& g : {0.0213, 0.1077, 0.3017, 0.0513}) {
+            xt::xtensor<double, 3> eps = 0.001 * xt::random::randn<double>({n, 3ul, 3ul});
+            for (size_t p = 0; p < n; ++p) {
+                eps(p, 0, 1) = eps(p, 1, 0) = g * static_cast<double>(p % 10 + 1) / 10.0;
+                eps(p, 0, 2) = eps(p, 2, 0);
+                eps(p, 1, 2) = eps(p, 2, 1);
+            }
+
+            mat.setStrain(eps);
+            mixed.setStrain(eps);
+
+            REQUIRE(xt::all(xt::equal(mixed.CurrentIndex(), mat.CurrentIndex())));
+            REQUIRE(xt::allclose(mixed.Strain(), mat.Strain(), rtol, atol));
+            REQUIRE(xt::allclose(mixed.Stress(), mat.Stress(), rtol, atol));
+            REQUIRE(xt::allclose(mixed.Energy(), mat.Energy(), rtol, atol));
+            REQUIRE(xt::allclose(mixed.Epsp(), mat.Epsp(), rtol, atol));
+            REQUIRE(xt::allclose(mixed.CurrentYieldLeft(), mat.CurrentYieldLeft(), rtol, atol));
+            REQUIRE(xt::allclose(mixed.CurrentYieldRight(), mat.CurrentYieldRight(), rtol, atol));
+        }
+    }
+
+    SECTION("Array - interleaved types")
+    {
+        size_t n = 2 * GM::detail::group_chunk + 41; // several chunks when grouping by type
+        GM::Array<1> mat({n});
+
+        xt::xtensor<size_t, 1> E = xt::zeros<size_t>({n});
+        xt::xtensor<size_t, 1> C = xt::zeros<size_t>({n});
+        xt::xtensor<size_t, 1> S = xt::zeros<size_t>({n});
+        for (size_t p = 0; p < n - 1; ++p) {
+            (p % 5 == 0 ? E : p % 5 == 3 ? S : C)(p) = 1; // last point unset
+        }
+
+        xt::xtensor<double, 1> epsy = 0.005 + 0.01 * xt::arange<double>(100);
+        mat.setElastic(E, 12.3, 45.6);
+        mat.setCusp(C, 12.3, 45.6, epsy);
+        mat.setSmooth(S, 12.3, 45.6, epsy);
+
+        GM::Elastic elastic(12.3, 45.6);
+        GM::Cusp cusp(12.3, 45.6, epsy);
+        GM::Smooth smooth(12.3, 45.6, epsy);
+
+        for (auto& g : {0.0213, 0.1077, 0.0513}) {
+            xt::xtensor<double, 3> eps = xt::zeros<double>({n, 3ul, 3ul});
+            for (size_t p = 0; p < n; ++p) {
+                eps(p, 0, 1) = eps(p, 1, 0) = g * static_cast<double>(p % 10 + 1) / 10.0;
+                eps(p, 0, 0) = 0.001 * g;
+            }
+
+            mat.setStrain(eps);
+            xt::xtensor<double, 3> sig = mat.Stress();
+            xt::xtensor<double, 1> energy = mat.Energy();
+            xt::xtensor<size_t, 1> index = mat.CurrentIndex();
+
+            for (size_t p = 0; p < n - 1; ++p) {
+                xt::xtensor<double, 2> eps_p = xt::view(eps, p);
+                xt::xtensor<double, 2> sig_p = xt::view(sig, p);
+                if (E(p)) {
+                    elastic.setStrain(eps_p);
+                    REQUIRE(xt::allclose(sig_p, elastic.Stress()));
+                    REQUIRE(energy(p) == Approx(elastic.energy()));
+                }
+                else if (C(p)) {
+                    cusp.setStrain(eps_p);
+                    REQUIRE(xt::allclose(sig_p, cusp.Stress()));
+                    REQUIRE(energy(p) == Approx(cusp.energy()));
+                    REQUIRE(index(p) == cusp.currentIndex());
+                }
+                else {
+                    smooth.setStrain(eps_p);
+                    REQUIRE(xt::allclose(sig_p, smooth.Stress()));
+                    REQUIRE(energy(p) == Approx(smooth.energy()));
+                    REQUIRE(index(p) == smooth.currentIndex());
+                }
+            }
+
+            REQUIRE(xt::allclose(xt::view(sig, n - 1), 0.0));
+        }
+    }
+
+    SECTION("Array - landscape callback")
+    {
+        size_t nelem = 1500; // more than one batch of landscapes
+        size_t nip = 2;
+        xt::xtensor<size_t, 2> I = xt::ones<size_t>({nelem, nip});
+        xt::xtensor<size_t, 2> idx = xt::zeros<size_t>({nelem, nip});
+        xt::xtensor<double, 2> epsy = xt::zeros<double>({nelem, 10ul});
+        xt::xtensor<double, 1> K = 12.3 * xt::ones<double>({nelem});
+        xt::xtensor<double, 1> G = 45.6 * xt::ones<double>({nelem});
+
+        auto row = [](size_t e) -> xt::xtensor<double, 1> {
+            return 0.001 * static_cast<double>(e % 7 + 1) + 0.01 * xt::arange<double>(10);
+        };
+
+        for (size_t e = 0; e < nelem; ++e) {
+            xt::view(idx, e, xt::all()) = e;
+            xt::view(epsy, e, xt::all()) = row(e);
+        }
+
+        I(3, 1) = 0; // a partial selection
+
+        GM::Array<2> mat({nelem, nip});
+        GM::Array<2> gen({nelem, nip});
+        mat.setSmooth(I, idx, K, G, epsy);
+        gen.setSmooth(I, idx, K, G, row);
+
+        xt::xtensor<double, 4> eps = xt::zeros<double>({nelem, nip, 3ul, 3ul});
+        for (size_t e = 0; e < nelem; ++e) {
+            for (size_t q = 0; q < nip; ++q) {
+                eps(e, q, 0, 1) = eps(e, q, 1, 0) = 0.001 * static_cast<double>(e % 50);
+            }
+        }
+
+        mat.setStrain(eps);
+        gen.setStrain(eps);
+
+        REQUIRE(xt::allclose(gen.Stress(), mat.Stress()));
+        REQUIRE(xt::allclose(gen.CurrentYieldLeft(), mat.CurrentYieldLeft()));
+        REQUIRE(xt::allclose(gen.CurrentYieldRight(), mat.CurrentYieldRight()));
+        REQUIRE(xt::all(xt::equal(gen.CurrentIndex(), mat.CurrentIndex())));
+        REQUIRE(xt::all(xt::equal(gen.type(), mat.type())));
+    }
+
+    SECTION("Array - memory-mapped input")
+    {
+        TempDir tmp;
+
+        // minimal ".npy" writer (version 1.0)
+        auto save = [](const std::string& name, const std::string& descr, const std::string& shape,
+                       const void* data, size_t nbytes) {
+            std::string header = "{'descr': '" + descr + "', 'fortran_order': False, 'shape': ";
+            header += shape + ", }";
+            size_t n = 64 * ((10 + header.size() + 1 + 63) / 64) - 10;
+            header.resize(n - 1, ' ');
+            header += '\n';
+            char len[2] = {static_cast<char>(n & 0xff), static_cast<char>(n >> 8)};
+            std::ofstream file(name, std::ios::binary);
+            file.write("\x93NUMPY\x01\x00", 8);
+            file.write(len, 2);
+            file.write(header.data(), n);
+            file.write(static_cast<const char*>(data), nbytes);
+        };
+
+        size_t nelem = 6;
+        size_t nip = 3;
+        xt::xtensor<size_t, 2> I = xt::ones<size_t>({nelem, nip});
+        xt::xtensor<size_t, 2> idx = xt::zeros<size_t>({nelem, nip});
+        xt::xtensor<double, 1> K = 12.3 + xt::arange<double>(nelem);
+        xt::xtensor<double, 1> G = 45.6 + xt::arange<double>(nelem);
+        xt::xtensor<double, 2> epsy = xt::zeros<double>({nelem, 10ul});
+
+        for (size_t e = 0; e < nelem; ++e) {
+            xt::view(idx, e, xt::all()) = nelem - 1 - e;
+            xt::view(epsy, e, xt::all()) =
+                0.001 * static_cast<double>(e + 1) + 0.01 * xt::arange<double>(10);
+        }
+
+        I(2, 1) = 0;
+        epsy(0, 0) = -epsy(0, 1); // symmetric first well: nothing is prepended
+        std::reverse(epsy.begin() + 30, epsy.begin() + 40); // unsorted row
+
+        std::string shape2 = "(" + std::to_string(nelem) + ", " + std::to_string(nip) + ")";
+        std::string shape1 = "(" + std::to_string(nelem) + ",)";
+        std::string shapey = "(" + std::to_string(nelem) + ", 10)";
+        save(tmp.path("I.npy"), "<u8", shape2, I.data(), I.size() * sizeof(size_t));
+        save(tmp.path("idx.npy"), "<i8", shape2, idx.data(), idx.size() * sizeof(size_t));
+        save(tmp.path("K.npy"), "<f8", shape1, K.data(), K.size() * sizeof(double));
+        save(tmp.path("G.npy"), "<f8", shape1, G.data(), G.size() * sizeof(double));
+        save(tmp.path("epsy.npy"), "<f8", shapey, epsy.data(), epsy.size() * sizeof(double));
+
+        {
+            std::ofstream file(tmp.path("K.bin"), std::ios::binary);
+            file.write(reinterpret_cast<const char*>(K.data()), K.size() * sizeof(double));
+        }
+
+        xt::xtensor<int64_t, 2> negative = xt::zeros<int64_t>({nelem, nip});
+        negative(1, 2) = -1;
+        size_t nbytes = negative.size() * sizeof(int64_t);
+        save(tmp.path("neg.npy"), "<i8", shape2, negative.data(), nbytes);
+        REQUIRE_THROWS(GM::Mapped<size_t>(tmp.path("neg.npy")));
+
+        GM::Mapped<double> K_raw(tmp.path("K.bin"), {nelem});
+        GM::Mapped<double> epsy_npy(tmp.path("epsy.npy"));
+        REQUIRE(K_raw.size() == nelem);
+        REQUIRE(std::equal(K.cbegin(), K.cend(), K_raw.data()));
+        REQUIRE(epsy_npy.shape() == std::vector<size_t>{nelem, 10});
+        REQUIRE(std::equal(epsy.cbegin(), epsy.cend(), epsy_npy.data()));
+
+        GM::Array<2> mat({nelem, nip});
+        GM::Array<2> mapped({nelem, nip});
+        mat.setCusp(I, idx, K, G, epsy);
+        mapped.setCusp(
+            GM::Mapped<size_t>(tmp.path("I.npy")),
+            GM::Mapped<size_t>(tmp.path("idx.npy")),
+            GM::Mapped<double>(tmp.path("K.npy")),
+            GM::Mapped<double>(tmp.path("G.npy")),
+            epsy_npy);
+
+        for (size_t e = 0; e < nelem; ++e) {
+            REQUIRE(xt::all(xt::equal(
+                mapped.getCusp({e, 0}).epsy(), mat.getCusp({e, 0}).epsy())));
+        }
+
+        xt::xtensor<double, 4> eps = xt::zeros<double>({nelem, nip, 3ul, 3ul});
+        for (size_t e = 0; e < nelem; ++e) {
+            for (size_t q = 0; q < nip; ++q) {
+                eps(e, q, 0, 1) = eps(e, q, 1, 0) = 0.01 * static_cast<double>(e * nip + q);
+            }
+        }
+
+        mat.setStrain(eps);
+        mapped.setStrain(eps);
+
+        REQUIRE(xt::allclose(mapped.K(), mat.K()));
+        REQUIRE(xt::allclose(mapped.Stress(), mat.Stress()));
+        REQUIRE(xt::allclose(mapped.CurrentYieldLeft(), mat.CurrentYieldLeft()));
+        REQUIRE(xt::allclose(mapped.CurrentYieldRight(), mat.CurrentYieldRight()));
+        REQUIRE(xt::all(xt::equal(mapped.CurrentIndex(), mat.CurrentIndex())));
+        REQUIRE(xt::all(xt::equal(mapped.type(), mat.type())));
+    }
+
+    SECTION("Array - checkpoint")
+    {
+        size_t n = 30;
+        GM::Array<1> mat({n});
+
+        xt::xtensor<size_t, 1> E = xt::zeros<size_t>({n});
+        xt::xtensor<size_t, 1> C = xt::zeros<size_t>({n});
+        xt::xtensor<size_t, 1> S = xt::zeros<size_t>({n});
+        xt::xtensor<size_t, 1> P = xt::zeros<size_t>({n});
+        for (size_t p = 0; p < n - 1; ++p) {
+            (p % 4 == 0 ? E : p % 4 == 1 ? C : p % 4 == 2 ? S : P)(p) = 1; // last point unset
+        }
+
+        xt::xtensor<double, 1> epsy = 0.005 + 0.01 * xt::arange<double>(100);
+        mat.setElastic(E, 12.3, 45.6);
+        mat.setCusp(C, 12.3, 45.6, epsy);
+        mat.setSmooth(S, 12.3, 45.6, epsy);
+        mat.setCusp(P, 12.3, 45.6, GM::Procedural(GM::Procedural::Weibull, 2.0, 0.01, 0.001, 3, 8));
+        mat.setStorageMandel();
+
+        auto strain = [n](double g) {
+            xt::xtensor<double, 3> eps = xt::zeros<double>({n, 3ul, 3ul});
+            for (size_t p = 0; p < n; ++p) {
+                eps(p, 0, 1) = eps(p, 1, 0) = g * static_cast<double>(p % 10 + 1) / 10.0;
+                eps(p, 2, 2) = 0.01 * g;
+            }
+            return eps;
+        };
+
+        mat.setStrain(strain(0.1077));
+        TempDir tmp;
+        mat.save(tmp.path("checkpoint.bin"));
+
+        GM::Array<1> restart;
+        restart.load(tmp.path("checkpoint.bin"));
+
+        REQUIRE(restart.isStorageMandel());
+        REQUIRE(xt::all(xt::equal(restart.type(), mat.type())));
+        REQUIRE(xt::all(xt::equal(restart.CurrentIndex(), mat.CurrentIndex())));
+        REQUIRE(xt::allclose(restart.Strain(), mat.Strain()));
+        REQUIRE(xt::allclose(restart.Stress(), mat.Stress()));
+        REQUIRE(xt::allclose(restart.Energy(), mat.Energy()));
+        REQUIRE(xt::allclose(restart.CurrentYieldLeft(), mat.CurrentYieldLeft()));
+
+        // invalid files are rejected, and leave the array unchanged
+        std::string data;
+        {
+            std::ifstream file(tmp.path("checkpoint.bin"), std::ios::binary);
+            data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+
+        auto corrupt = [&](size_t position, char value, size_t size) {
+            std::string copy = data.substr(0, size);
+            if (position < size) {
+                copy[position] = value;
+            }
+            std::ofstream file(tmp.path("corrupt.bin"), std::ios::binary | std::ios::trunc);
+            file.write(copy.data(), copy.size());
+            file.close();
+            REQUIRE_THROWS(restart.load(tmp.path("corrupt.bin")));
+            REQUIRE(xt::all(xt::equal(restart.CurrentIndex(), mat.CurrentIndex())));
+        };
+
+        size_t payload = 8 + 9 * 8 + 6 * 8; // magic, header, one procedural landscape
+        corrupt(8, 3, data.size());             // version
+        corrupt(16, 1, data.size());            // byte order
+        corrupt(payload, 7, data.size());       // type of the first point
+        corrupt(8 + 5 * 8, 9, data.size());     // storage
+        corrupt(8 + 9 * 8, 5, data.size());     // distribution
+        corrupt(0, 'G', data.size() - 1);       // truncated
+        corrupt(0, 'G', 50);                    // truncated header
+
+        for (auto& g : {0.0213, 0.1513}) {
+            mat.setStrain(strain(g));
+            restart.setStrain(strain(g));
+            REQUIRE(xt::all(xt::equal(restart.CurrentIndex(), mat.CurrentIndex())));
+            REQUIRE(xt::allclose(restart.Stress(), mat.Stress()));
+            REQUIRE(xt::allclose(restart.CurrentYieldRight(), mat.CurrentYieldRight()));
+        }
+    }
+
+    SECTION("Array - warm start")
+    {
+        size_t n = 10;
+        xt::xtensor<size_t, 1> I = xt::ones<size_t>({n});
+        GM::Procedural gen(GM::Procedural::Weibull, 2.0, 0.01, 0.001, 5, 8);
+
+        auto strain = [n](double g) {
+            xt::xtensor<double, 3> eps = xt::zeros<double>({n, 3ul, 3ul});
+            for (size_t p = 0; p < n; ++p) {
+                eps(p, 0, 1) = eps(p, 1, 0) = g * static_cast<double>(p + 1) / 10.0;
+                eps(p, 2, 2) = 0.01 * g;
+            }
+            return eps;
+        };
+
+        GM::Array<1> cold({n});
+        cold.setSmooth(I, 12.3, 45.6, gen);
+        cold.setStrain(strain(1.0013));
+        REQUIRE(cold.CurrentIndex()(n - 1) > 50);
+
+        // exact well, and the state of an earlier run (a well further left): the same state
+        GM::Array<1> prev({n});
+        prev.setSmooth(I, 12.3, 45.6, gen);
+        prev.setStrain(strain(0.5031));
+        REQUIRE(prev.CurrentIndex()(n - 1) < cold.CurrentIndex()(n - 1));
+
+        GM::Array<1> warm({n});
+        GM::Array<1> hint({n});
+        xt::xtensor<double, 1> epsy_l = cold.CurrentYieldLeft();
+        xt::xtensor<double, 1> prev_l = prev.CurrentYieldLeft();
+        warm.setSmooth(I, 12.3, 45.6, gen, cold.CurrentIndex(), epsy_l, strain(1.0013));
+        hint.setSmooth(I, 12.3, 45.6, gen, prev.CurrentIndex(), prev_l, strain(0.5031));
+        REQUIRE(xt::allclose(warm.CurrentYieldLeft(), epsy_l));
+        REQUIRE(xt::allclose(hint.Stress(), prev.Stress()));
+
+        // the strain outside the given well
+        GM::Array<1> wrong({n});
+        REQUIRE_THROWS(
+            wrong.setSmooth(I, 12.3, 45.6, gen, prev.CurrentIndex(), prev_l, strain(1.0013)));
+
+        for (auto& g : {1.0013, 1.0213, 0.5031}) {
+            cold.setStrain(strain(g));
+            warm.setStrain(strain(g));
+            hint.setStrain(strain(g));
+            REQUIRE(xt::all(xt::equal(warm.CurrentIndex(), cold.CurrentIndex())));
+            REQUIRE(xt::all(xt::equal(hint.CurrentIndex(), cold.CurrentIndex())));
+            REQUIRE(xt::allclose(warm.CurrentYieldLeft(), cold.CurrentYieldLeft()));
+            REQUIRE(xt::allclose(warm.CurrentYieldRight(), cold.CurrentYieldRight()));
+            REQUIRE(xt::allclose(warm.Stress(), cold.Stress()));
+            REQUIRE(xt::allclose(warm.Energy(), cold.Energy()));
+        }
+
+        // material point
+        xt::xtensor<double, 1> epsy = 0.005 + 0.01 * xt::arange<double>(1000);
+        xt::xtensor<double, 3> eps = strain(1.0013);
+        xt::xtensor<double, 2> Eps = xt::view(eps, n - 1);
+        GM::Cusp cusp(12.3, 45.6, epsy);
+        GM::Cusp cusp_warm(12.3, 45.6, epsy, Eps);
+        GM::Smooth smooth(12.3, 45.6, epsy);
+        GM::Smooth smooth_warm(12.3, 45.6, epsy, Eps);
+        cusp.setStrain(Eps);
+        smooth.setStrain(Eps);
+
+        REQUIRE(cusp_warm.currentIndex() == cusp.currentIndex());
+        REQUIRE(smooth_warm.currentIndex() == smooth.currentIndex());
+        REQUIRE(cusp_warm.energy() == Approx(cusp.energy()));
+        REQUIRE(xt::allclose(cusp_warm.Stress(), cusp.Stress()));
+        REQUIRE(xt::allclose(smooth_warm.Stress(), smooth.Stress()));
+    }
+
+    SECTION("Array - cached equivalent strain and stress")
+    {
+        size_t n = 12;
+        GM::Array<1> mat({n});
+
+        xt::xtensor<size_t, 1> E = xt::zeros<size_t>({n});
+        xt::xtensor<size_t, 1> C = xt::zeros<size_t>({n});
+        xt::xtensor<size_t, 1> S = xt::zeros<size_t>({n});
+        for (size_t p = 0; p < n - 1; ++p) {
+            (p % 3 == 0 ? E : p % 3 == 1 ? C : S)(p) = 1; // last point unset
+        }
+        xt::xtensor<double, 1> epsy = 0.005 + 0.01 * xt::arange<double>(100);
+        mat.setElastic(E, 12.3, 45.6);
+        mat.setCusp(C, 12.3, 45.6, epsy);
+        mat.setSmooth(S, 12.3, 45.6, epsy);
+
+        xt::xtensor<double, 3> eps = 0.01 * xt::random::randn<double>({n, 3ul, 3ul});
+        for (size_t p = 0; p < n; ++p) {
+            eps(p, 0, 1) = eps(p, 1, 0) = 0.1 * static_cast<double>(p);
+            eps(p, 0, 2) = eps(p, 2, 0);
+            eps(p, 1, 2) = eps(p, 2, 1);
+        }
+        mat.setStrain(eps);
+
+        REQUIRE(xt::allclose(mat.Epsd(), GM::Epsd(mat.Strain())));
+        REQUIRE(xt::allclose(mat.Sigd(), GM::Sigd(mat.Stress())));
+
+        GM::Cusp cusp(12.3, 45.6, epsy);
+        GM::Smooth smooth(12.3, 45.6, epsy);
+        xt::xtensor<double, 2> eps1 = xt::view(eps, 4);
+        cusp.setStrain(eps1);
+        smooth.setStrain(eps1);
+
+        REQUIRE(cusp.epsd() == Approx(GM::Epsd(eps1)()));
+        REQUIRE(cusp.sigd() == Approx(GM::Sigd(cusp.Stress())()));
+        REQUIRE(smooth.epsd() == Approx(GM::Epsd(eps1)()));
+        REQUIRE(smooth.sigd() == Approx(GM::Sigd(smooth.Stress())()));
+    }
 }